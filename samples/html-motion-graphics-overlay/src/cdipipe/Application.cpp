@@ -1,5 +1,9 @@
+#include <atomic>
+#include <mutex>
 #include <iostream>
 #include <cassert>
+#include <sstream>
+#include <cstdio>
 #include <conio.h>
 
 #include <cdi_core_api.h>
@@ -9,6 +13,15 @@
 #include "Cdi.h"
 #include "Configuration.h"
 #include "Channel.h"
+#include "TimeSource.h"
+#include "Compositor.h"
+#include "AudioConcealment.h"
+#include "VideoConcealment.h"
+#include "Exceptions.h"
+#include "NumaPlacement.h"
+#include "ConnectionPlanner.h"
+#include "StandbyGroup.h"
+#include "FormatConversion.h"
 
 static const char* logger_name = "Application";
 
@@ -50,29 +63,52 @@ CdiTools::Application::Application(
     , large_buffer_pool_item_size_{ large_buffer_pool_item_size }
     , small_buffer_pool_item_size_{ small_buffer_pool_item_size }
 {
+    void* tx_buffer_ptr = nullptr;
+    uint64_t tx_buffer_size = 0;
     Cdi::initialize(cdi_logger_, log_level, log_file_name);
     Cdi::initialize_adapter(adapter_ip_address, adapter_type,
         large_buffer_pool_item_size, large_buffer_pool_max_items,
         small_buffer_pool_item_size, small_buffer_pool_max_items,
-        adapter_handle_, large_buffer_pool_handle_, small_buffer_pool_handle_);
+        adapter_handle_, large_buffer_pool_handle_, small_buffer_pool_handle_,
+        tx_buffer_ptr, tx_buffer_size);
+
+    // the SDK allocates the transmit buffer that backs the payload pools, keep it next to the adapter
+    std::string description;
+    if (NumaPlacement::instance().is_enabled() && tx_buffer_size > 0) {
+        if (NumaPlacement::instance().bind_memory(tx_buffer_ptr, static_cast<size_t>(tx_buffer_size), description)) {
+            LOG_INFO << "Payload pools are placed on NUMA " << description << ".";
+        }
+        else {
+            LOG_WARNING << "Failed to place the payload pools on NUMA node " << NumaPlacement::instance().get_node() << ": " << description << ".";
+        }
+    }
+
+    large_buffer_cache_ = std::make_unique<PoolCache>(large_buffer_pool_handle_,
+        get_magazine_size(large_buffer_pool_max_items));
+    small_buffer_cache_ = std::make_unique<PoolCache>(small_buffer_pool_handle_,
+        get_magazine_size(small_buffer_pool_max_items));
 }
 
 CdiTools::Application::~Application()
 {
+    // all buffers must be back in the pools before they are destroyed
+    large_buffer_cache_.reset();
+    small_buffer_cache_.reset();
+
     Cdi::shutdown();
 }
 
 void* CdiTools::Application::get_pool_buffer(size_t payload_size)
 {
-    void* buffer_ptr = nullptr;
+    PoolCache* pool_cache = get_pool_cache(payload_size);
+    assert(pool_cache != nullptr);
 
-    CdiPoolHandle pool_handle = get_pool_handle(payload_size);
-    assert(pool_handle != NULL);
-
-    if (NULL == pool_handle || !CdiPoolGet(pool_handle, &buffer_ptr)) {
+    void* buffer_ptr = pool_cache != nullptr ? pool_cache->get() : nullptr;
+    if (buffer_ptr == nullptr && pool_cache != nullptr) {
+        CdiPoolHandle pool_handle = pool_cache->get_pool_handle();
         LOG_DEBUG << "Failed to allocate a payload buffer from the '" << CdiPoolGetName(pool_handle) << "' pool"
             << ", requested size: " << std::to_string(CdiPoolGetItemSize(pool_handle))
-            << ", free items: " << std::to_string(CdiPoolGetFreeItemCount(pool_handle))
+            << ", free items: " << std::to_string(pool_cache->get_free_count())
             << ".";
     }
 
@@ -81,109 +117,260 @@ void* CdiTools::Application::get_pool_buffer(size_t payload_size)
 
 void CdiTools::Application::free_pool_buffer(void* buffer_ptr, size_t payload_size)
 {
-    CdiPoolHandle pool_handle = get_pool_handle(payload_size);
-    assert(pool_handle != NULL);
+    PoolCache* pool_cache = get_pool_cache(payload_size);
+    assert(pool_cache != nullptr);
 
-    CdiPoolPut(pool_handle, buffer_ptr);
+    if (pool_cache != nullptr) {
+        pool_cache->put(buffer_ptr);
+    }
 }
 
 int CdiTools::Application::get_pool_free_buffer_count(size_t payload_size)
 {
-    CdiPoolHandle pool_handle = get_pool_handle(payload_size);
-    assert(pool_handle != NULL);
+    PoolCache* pool_cache = get_pool_cache(payload_size);
+    assert(pool_cache != nullptr);
 
-    int count = CdiPoolGetFreeItemCount(pool_handle);
+    int count = pool_cache != nullptr ? pool_cache->get_free_count() : 0;
 
     return count;
 }
 
 const char* CdiTools::Application::get_pool_name(size_t payload_size)
 {
-    CdiPoolHandle pool_handle = get_pool_handle(payload_size);
-    assert(pool_handle != NULL);
+    PoolCache* pool_cache = get_pool_cache(payload_size);
+    assert(pool_cache != nullptr);
 
-    const char* name = CdiPoolGetName(pool_handle);
+    const char* name = pool_cache != nullptr ? CdiPoolGetName(pool_cache->get_pool_handle()) : "";
 
     return name;
 }
 
-CdiPoolHandle CdiTools::Application::get_pool_handle(size_t payload_size)
+CdiTools::PoolCache* CdiTools::Application::get_pool_cache(size_t payload_size)
 {
     if (payload_size <= small_buffer_pool_item_size_) {
-        return small_buffer_pool_handle_;
+        return small_buffer_cache_.get();
     }
 
     if (payload_size <= large_buffer_pool_item_size_) {
-        return large_buffer_pool_handle_;
+        return large_buffer_cache_.get();
     }
 
     // TODO: make pool item sizes command line arguments?
     LOG_ERROR << "Requested payload size exceeds maximum allowed (" << large_buffer_pool_item_size_ << " bytes).";
 
-    return NULL;
+    return nullptr;
+}
+
+int CdiTools::Application::get_magazine_size(uint32_t pool_max_items)
+{
+    if (Configuration::pool_magazine_size >= 0) {
+        return Configuration::pool_magazine_size;
+    }
+
+    // buffers parked in per-thread magazines are unavailable to other threads, keep them a small share of the pool
+    int magazine_size = static_cast<int>(pool_max_items / 16);
+
+    return magazine_size >= 2 ? std::min(magazine_size, 16) : 0;
 }
 
 std::shared_ptr<CdiTools::Channel> CdiTools::Application::configure_channel(ChannelRole channel_role)
 {
     auto channel = std::make_shared<Channel>(enum_name(channel_role_map, channel_role));
     auto endpoint_connection_type = ConnectionType::Tcp;
-    auto channel_connection_type = ChannelType::Cdi == Configuration::channel_type || ChannelType::CdiStream == Configuration::channel_type
-        ? ConnectionType::Cdi : ConnectionType::Tcp;
+    auto is_planned = ChannelType::CdiAuto == Configuration::channel_type;
+    auto channel_connection_type = ChannelType::Cdi == Configuration::channel_type || ChannelType::CdiStream == Configuration::channel_type || is_planned
+        ? ConnectionType::Cdi : Configuration::tcp_stripes > 1 ? ConnectionType::StripedTcp : ConnectionType::Tcp;
 
     auto input_connection_type = ChannelRole::Transmitter == channel_role ? endpoint_connection_type : channel_connection_type;
     auto output_connection_type = ChannelRole::Receiver == channel_role ? endpoint_connection_type : channel_connection_type;
 
     // set up channel streams
-    channel->add_video_stream(Configuration::video_stream_id, Configuration::frame_width, Configuration::frame_height,
-        Configuration::bytes_per_pixel, Configuration::frame_rate_numerator, Configuration::frame_rate_denominator);
+    std::vector<std::shared_ptr<Stream>> channel_streams;
+    channel_streams.push_back(channel->add_video_stream(Configuration::video_stream_id, Configuration::frame_width, Configuration::frame_height,
+        Configuration::bytes_per_pixel, Configuration::frame_rate_numerator, Configuration::frame_rate_denominator));
     if (!Configuration::disable_audio) {
-        channel->add_audio_stream(Configuration::audio_stream_id, Configuration::audio_channel_grouping,
-            Configuration::audio_sampling_rate, Configuration::Configuration::audio_bytes_per_sample, Configuration::audio_stream_language);
+        channel_streams.push_back(channel->add_audio_stream(Configuration::audio_stream_id, Configuration::audio_channel_grouping,
+            Configuration::audio_sampling_rate, Configuration::Configuration::audio_bytes_per_sample, Configuration::audio_stream_language));
     }
 
     // configure channel connections
     auto video_buffer_size = static_cast<unsigned int>(Configuration::large_buffer_pool_max_items * 0.9);
     auto audio_buffer_size = static_cast<unsigned int>(Configuration::small_buffer_pool_max_items * 0.9);
     if (ChannelRole::Transmitter == channel_role) {
-        channel->add_input(input_connection_type, "video_in", "127.0.0.1", Configuration::video_in_port, ConnectionMode::Listener, 0);
-        channel->add_output(output_connection_type, ChannelType::CdiStream != Configuration::channel_type ? "video_out" : "avid_out",
-            Configuration::remote_ip, Configuration::port_number, ConnectionMode::Client,
-            ChannelType::CdiStream != Configuration::channel_type ? video_buffer_size : video_buffer_size + audio_buffer_size);
+        if (!Configuration::video_in_pipe.empty()) {
+            channel->add_input(ConnectionType::Pipe, "video_in", Configuration::video_in_pipe, 0, ConnectionMode::Listener, 0);
+        }
+        else {
+            channel->add_input(input_connection_type, "video_in", "127.0.0.1", Configuration::video_in_port, ConnectionMode::Listener, 0);
+        }
+
+        if (is_planned) {
+            add_planned_connections(channel, channel_streams, channel_role, video_buffer_size, audio_buffer_size);
+        }
+        else {
+            channel->add_output(output_connection_type, ChannelType::CdiStream != Configuration::channel_type ? "video_out" : "avid_out",
+                Configuration::remote_ip, Configuration::port_number, ConnectionMode::Client,
+                ChannelType::CdiStream != Configuration::channel_type ? video_buffer_size : video_buffer_size + audio_buffer_size);
+        }
 
         if (!Configuration::disable_audio) {
-            channel->add_input(input_connection_type, "audio_in", "127.0.0.1", Configuration::audio_in_port, ConnectionMode::Listener, 0);
-            if (ChannelType::CdiStream != Configuration::channel_type) {
+            if (!Configuration::audio_in_pipe.empty()) {
+                channel->add_input(ConnectionType::Pipe, "audio_in", Configuration::audio_in_pipe, 0, ConnectionMode::Listener, 0);
+            }
+            else {
+                channel->add_input(input_connection_type, "audio_in", "127.0.0.1", Configuration::audio_in_port, ConnectionMode::Listener, 0);
+            }
+
+            if (ChannelType::CdiStream != Configuration::channel_type && !is_planned) {
                 channel->add_output(output_connection_type, "audio_out", Configuration::remote_ip, Configuration::port_number + 1, ConnectionMode::Client, audio_buffer_size);
             }
         }
 
+        // composite the overlay onto the video before it is transmitted
+        if (!Configuration::overlay_in_pipe.empty()) {
+            int overlay_width = Configuration::overlay_width > 0 ? Configuration::overlay_width : Configuration::frame_width;
+            int overlay_height = Configuration::overlay_height > 0 ? Configuration::overlay_height : Configuration::frame_height;
+            if (static_cast<uint32_t>(overlay_width * overlay_height * OverlayFrame::bytes_per_pixel) > Configuration::large_buffer_pool_item_size) {
+                throw InvalidConfigurationException("Overlay frame size exceeds the size of the payload buffers.");
+            }
+
+            // the latency marker is stamped before the pipeline runs, so the compositor must not draw over it
+            // unless it is removed from the frame
+            bool preserve_latency_marker = LatencyMarkerMode::None != Configuration::latency_marker
+                && LatencyMarkerMode::Remove != Configuration::latency_marker;
+            auto compositor = std::make_shared<CompositorStage>(Configuration::overlay_left, Configuration::overlay_top,
+                preserve_latency_marker);
+            channel->add_video_stream(Configuration::overlay_stream_id, overlay_width, overlay_height, OverlayFrame::bytes_per_pixel,
+                Configuration::frame_rate_numerator, Configuration::frame_rate_denominator);
+            channel->add_input(ConnectionType::Pipe, "overlay_in", Configuration::overlay_in_pipe, 0, ConnectionMode::Listener, 0);
+            channel->map_stream(Configuration::overlay_stream_id, "overlay_in");
+            channel->add_stage(std::make_shared<OverlayInputStage>(compositor, overlay_width, overlay_height, Configuration::overlay_autocrop), false, Configuration::overlay_stream_id);
+            channel->add_stage(compositor, false, Configuration::video_stream_id);
+        }
+
         // map streams to connections
         channel->map_stream(Configuration::video_stream_id, "video_in");
-        channel->map_stream(Configuration::video_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "video_out" : "avid_out");
+        if (!is_planned) {
+            channel->map_stream(Configuration::video_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "video_out" : "avid_out");
+        }
+
         if (!Configuration::disable_audio) {
             channel->map_stream(Configuration::audio_stream_id, "audio_in");
-            channel->map_stream(Configuration::audio_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "audio_out" : "avid_out");
+            if (!is_planned) {
+                channel->map_stream(Configuration::audio_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "audio_out" : "avid_out");
+            }
         }
     }
     else if (ChannelRole::Receiver == channel_role) {
-        channel->add_input(input_connection_type, ChannelType::CdiStream != Configuration::channel_type ? "video_in" : "avid_in",
-            Configuration::remote_ip, Configuration::port_number, ConnectionMode::Listener, 0);
-        channel->add_output(output_connection_type, "video_out", "127.0.0.1", Configuration::video_out_port, ConnectionMode::Listener, video_buffer_size);
+        if (is_planned) {
+            add_planned_connections(channel, channel_streams, channel_role, video_buffer_size, audio_buffer_size);
+        }
+        else {
+            channel->add_input(input_connection_type, ChannelType::CdiStream != Configuration::channel_type ? "video_in" : "avid_in",
+                Configuration::remote_ip, Configuration::port_number, ConnectionMode::Listener, 0);
+        }
+
+        if (!Configuration::video_out_pipe.empty()) {
+            channel->add_output(ConnectionType::Pipe, "video_out", Configuration::video_out_pipe, 0, ConnectionMode::Client, video_buffer_size);
+        }
+        else {
+            channel->add_output(output_connection_type, "video_out", "127.0.0.1", Configuration::video_out_port, ConnectionMode::Listener, video_buffer_size);
+        }
 
         if (!Configuration::disable_audio) {
-            if (ChannelType::CdiStream != Configuration::channel_type) {
+            if (ChannelType::CdiStream != Configuration::channel_type && !is_planned) {
                 channel->add_input(input_connection_type, "audio_in", Configuration::remote_ip, Configuration::port_number + 1, ConnectionMode::Listener, 0);
             }
 
-            channel->add_output(output_connection_type, "audio_out", "127.0.0.1", Configuration::audio_out_port, ConnectionMode::Listener, audio_buffer_size);
+            if (!Configuration::audio_out_pipe.empty()) {
+                channel->add_output(ConnectionType::Pipe, "audio_out", Configuration::audio_out_pipe, 0, ConnectionMode::Client, audio_buffer_size);
+            }
+            else {
+                channel->add_output(output_connection_type, "audio_out", "127.0.0.1", Configuration::audio_out_port, ConnectionMode::Listener, audio_buffer_size);
+            }
         }
 
         // map streams to connections
-        channel->map_stream(Configuration::video_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "video_in" : "avid_in");
+        if (!is_planned) {
+            channel->map_stream(Configuration::video_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "video_in" : "avid_in");
+        }
+
         channel->map_stream(Configuration::video_stream_id, "video_out");
+
+        // outputs that take the video in another pixel format share a single conversion per frame and format
+        auto conversion_cache = std::make_shared<ConversionCache>(8);
+        if (!Configuration::video_out_format.empty()) {
+            auto pixel_format = pixel_format_map.find(Configuration::video_out_format);
+            if (pixel_format == pixel_format_map.end()) {
+                throw InvalidConfigurationException("Invalid video output pixel format '" + Configuration::video_out_format + "'.");
+            }
+
+            add_format_conversion(channel, "video_out", pixel_format->second, conversion_cache);
+        }
+
+        // additional video outputs are given as format:port pairs separated by ';'
+        std::istringstream video_outputs(Configuration::video_outputs);
+        int video_output_count = 1;
+        for (std::string video_output; std::getline(video_outputs, video_output, ';');) {
+            if (video_output.empty()) continue;
+
+            auto separator = video_output.find(':');
+            auto pixel_format = pixel_format_map.find(video_output.substr(0, separator));
+            int port_number = separator != std::string::npos ? std::atoi(video_output.c_str() + separator + 1) : 0;
+            if (pixel_format == pixel_format_map.end() || port_number <= 0 || port_number > 65535) {
+                throw InvalidConfigurationException("Invalid video output '" + video_output + "', expected a pixel format and a port number, e.g. Bgra:3010.");
+            }
+
+            auto connection_name = "video_out" + std::to_string(++video_output_count);
+            channel->add_output(output_connection_type, connection_name, "127.0.0.1", static_cast<unsigned short>(port_number), ConnectionMode::Listener, video_buffer_size);
+            channel->map_stream(Configuration::video_stream_id, connection_name);
+            add_format_conversion(channel, connection_name, pixel_format->second, conversion_cache);
+        }
+
+        if (Configuration::video_concealment) {
+            channel->add_stage(std::make_shared<VideoConcealmentStage>(), false, Configuration::video_stream_id);
+        }
+
+        // renditions are scaled from the received, possibly concealed frames, each one is a stream delivered to its own output
+        std::istringstream video_renditions(Configuration::video_renditions);
+        uint16_t rendition_stream_id = Configuration::rendition_stream_id;
+        for (std::string video_rendition; std::getline(video_renditions, video_rendition, ';');) {
+            if (video_rendition.empty()) continue;
+
+            int frame_width = 0;
+            int frame_height = 0;
+            int port_number = 0;
+            if (std::sscanf(video_rendition.c_str(), "%dx%d:%d", &frame_width, &frame_height, &port_number) != 3
+                || frame_width <= 0 || frame_height <= 0 || port_number <= 0 || port_number > 65535) {
+                throw InvalidConfigurationException("Invalid video rendition '" + video_rendition + "', expected a frame size and a port number, e.g. 1280x720:3030.");
+            }
+
+            if (!is_packed(Configuration::pixel_format)) {
+                throw InvalidConfigurationException("Video renditions can only be scaled from packed RGB formats, not from "
+                    + enum_name(pixel_format_map, Configuration::pixel_format) + ".");
+            }
+
+            if (static_cast<uint32_t>(get_frame_size(Configuration::pixel_format, frame_width, frame_height)) > Configuration::large_buffer_pool_item_size) {
+                throw InvalidConfigurationException("Frames of video rendition '" + video_rendition + "' exceed the payload buffer size.");
+            }
+
+            auto connection_name = "video_rendition" + std::to_string(rendition_stream_id);
+            channel->add_rendition(Configuration::video_stream_id, rendition_stream_id, frame_width, frame_height, Configuration::scaling_filter);
+            channel->add_output(output_connection_type, connection_name, "127.0.0.1", static_cast<unsigned short>(port_number), ConnectionMode::Listener, video_buffer_size);
+            channel->map_stream(rendition_stream_id++, connection_name);
+        }
+
         if (!Configuration::disable_audio) {
-            channel->map_stream(Configuration::audio_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "audio_in" : "avid_in");
+            if (!is_planned) {
+                channel->map_stream(Configuration::audio_stream_id, ChannelType::CdiStream != Configuration::channel_type ? "audio_in" : "avid_in");
+            }
+
             channel->map_stream(Configuration::audio_stream_id, "audio_out");
+
+            // only CDI payloads carry the origination timestamps needed to detect gaps
+            if (Configuration::audio_concealment) {
+                channel->add_stage(std::make_shared<AudioConcealmentStage>(), false, Configuration::audio_stream_id);
+            }
         }
     }
     else if (ChannelRole::Bridge == channel_role) {
@@ -206,11 +393,75 @@ std::shared_ptr<CdiTools::Channel> CdiTools::Application::configure_channel(Chan
         std::cout << "ERROR: Channel role is not supported.\n";
     }
 
+    // emulate a degraded network on the channel side of the pipe
+    if (!Configuration::rx_impairment.empty() && ChannelRole::Transmitter != channel_role) {
+        channel->impair_connections(ConnectionDirection::In, ImpairmentProfile::parse(Configuration::rx_impairment));
+    }
+
+    if (!Configuration::tx_impairment.empty() && ChannelRole::Receiver != channel_role) {
+        channel->impair_connections(ConnectionDirection::Out, ImpairmentProfile::parse(Configuration::tx_impairment));
+    }
+
+    // plugins are separated by ';', each one optionally followed by '?' and its arguments
+    std::istringstream plugins(Configuration::plugins);
+    for (std::string plugin; std::getline(plugins, plugin, ';');) {
+        if (!plugin.empty()) {
+            channel->add_plugin(plugin);
+        }
+    }
+
     channel->validate_configuration();
 
     return channel;
 }
 
+void CdiTools::Application::add_format_conversion(std::shared_ptr<Channel> channel, const std::string& connection_name,
+    PixelFormat pixel_format, std::shared_ptr<ConversionCache> conversion_cache)
+{
+    if (pixel_format == Configuration::pixel_format) return;
+
+    if (!is_packed(Configuration::pixel_format)) {
+        throw InvalidConfigurationException("Frames can only be converted from packed RGB formats, output '" + connection_name
+            + "' cannot be converted from " + enum_name(pixel_format_map, Configuration::pixel_format) + ".");
+    }
+
+    if (static_cast<uint32_t>(get_frame_size(pixel_format, Configuration::frame_width, Configuration::frame_height)) > Configuration::large_buffer_pool_item_size) {
+        throw InvalidConfigurationException("Frames converted to " + enum_name(pixel_format_map, pixel_format) + " for output '"
+            + connection_name + "' exceed the payload buffer size.");
+    }
+
+    // conversions run on the worker pool, off the thread that receives the stream
+    channel->add_output_stage(connection_name, std::make_shared<FormatConversionStage>(conversion_cache, Configuration::pixel_format, pixel_format), true);
+}
+
+void CdiTools::Application::add_planned_connections(std::shared_ptr<Channel> channel, const std::vector<std::shared_ptr<Stream>>& streams,
+    ChannelRole channel_role, unsigned int video_buffer_size, unsigned int audio_buffer_size)
+{
+    // both ends compute the same plan, the transmitter connects to the ports where the receiver listens
+    bool is_transmitter = ChannelRole::Transmitter == channel_role;
+    auto connections = ConnectionPlanner::plan(streams, Configuration::cdi_connection_bandwidth,
+        is_transmitter ? "_out" : "_in", Configuration::port_number);
+    ConnectionPlanner::show_plan(connections, Configuration::cdi_connection_bandwidth);
+
+    for (auto&& connection : connections) {
+        unsigned int buffer_size = 0;
+        for (auto stream_identifier : connection.stream_identifiers) {
+            buffer_size += Configuration::video_stream_id == stream_identifier ? video_buffer_size : audio_buffer_size;
+        }
+
+        if (is_transmitter) {
+            channel->add_output(ConnectionType::Cdi, connection.name, Configuration::remote_ip, connection.port_number, ConnectionMode::Client, buffer_size);
+        }
+        else {
+            channel->add_input(ConnectionType::Cdi, connection.name, Configuration::remote_ip, connection.port_number, ConnectionMode::Listener, 0);
+        }
+
+        for (auto stream_identifier : connection.stream_identifiers) {
+            channel->map_stream(stream_identifier, connection.name);
+        }
+    }
+}
+
 int CdiTools::Application::run(ChannelRole channel_role, bool show_channel_config)
 {
     int exit_code = 0;
@@ -220,13 +471,25 @@ int CdiTools::Application::run(ChannelRole channel_role, bool show_channel_confi
 
     try
     {
+        // threads and queues created from here on inherit the placement of the main thread
+        std::string description;
+        if (NumaPlacement::instance().is_enabled() && !NumaPlacement::instance().bind_current_thread(description)) {
+            std::cout << "WARNING: Failed to bind to NUMA node " << NumaPlacement::instance().get_node() << ": " << description << ".\n";
+        }
+
+        // calibrate the reference clock before the first payload is timestamped
+        TimeSource::instance();
+
         channel = configure_channel(channel_role);
         if (show_channel_config) {
             channel->show_configuration();
         }
 
-        if (channel_role == ChannelRole::Receiver
-            && (ChannelType::Cdi == Configuration::channel_type || ChannelType::CdiStream == Configuration::channel_type)) {
+        // CDI receivers take their payloads from the SDK and only need pools for frames they convert
+        bool is_converting = !Configuration::video_out_format.empty() || !Configuration::video_outputs.empty() || !Configuration::video_renditions.empty();
+        if (channel_role == ChannelRole::Receiver && !is_converting
+            && (ChannelType::Cdi == Configuration::channel_type || ChannelType::CdiStream == Configuration::channel_type
+                || ChannelType::CdiAuto == Configuration::channel_type)) {
             start(Configuration::local_ip.c_str(), Configuration::adapter_type, 0, 0, 0, 0, LogLevel::Info);
         }
         else {
@@ -235,36 +498,91 @@ int CdiTools::Application::run(ChannelRole channel_role, bool show_channel_confi
                 Configuration::small_buffer_pool_item_size, Configuration::small_buffer_pool_max_items, LogLevel::Info);
         }
 
+        // a standby initializes its adapter and pools above and only opens the channel once it takes over
+        std::unique_ptr<StandbyGroup> standby_group;
+        std::atomic_bool is_quitting{ false };
+        std::atomic_bool has_stopped{ false };
+        std::mutex shutdown_gate;
+        auto shutdown_channel = [&]() {
+            std::lock_guard<std::mutex> lock(shutdown_gate);
+            channel->shutdown();
+        };
+
+        if (!Configuration::standby_group.empty()) {
+            if (Configuration::standby_timeout <= 0) {
+                throw InvalidConfigurationException("The standby timeout must be a positive number of milliseconds.");
+            }
+
+            // a fenced primary must stop sending at once, the other process now owns the outputs
+            standby_group = std::make_unique<StandbyGroup>(Configuration::standby_group, std::chrono::milliseconds(Configuration::standby_timeout),
+                [&]() {
+                    std::cout << "ERROR: Another process took over standby group '" << Configuration::standby_group << "', shutting the channel down.\n";
+                    shutdown_channel();
+                });
+        }
+
         std::thread shutdown([&]() {
             int key = 0;
             // TODO: this is not portable
             while (true) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+                // a fenced primary exits, the other process now owns the outputs
+                if (standby_group != nullptr && standby_group->is_fenced()) break;
+
                 if (_kbhit()) {
                     key = _getch();
                     if (key == 'q' || key == 'Q') break;
                     if (key == 'i' || key == 'I') Logger::set_level(LogLevel::Info);
                     if (key == 'd' || key == 'D') Logger::set_level(LogLevel::Debug);
                     if (key == 't' || key == 'T') Logger::set_level(LogLevel::Trace);
-                    if (key == 's' || key == 'S') channel->show_status();
+                    if (key == 's' || key == 'S') {
+                        channel->show_status();
+                        NumaPlacement::instance().show_status();
+                        if (standby_group != nullptr) {
+                            standby_group->show_status();
+                        }
+                    }
                 }
             }
 
-            channel->shutdown();
-        });
+            is_quitting = true;
+            shutdown_channel();
 
-        channel->start(channel_role, [](const std::error_code& ec) {
-            if (ec) {
-                std::cout << "ERROR: " << ec.message() << ".\n";
+            // also catches a primary fenced while its channel was still starting
+            while (!has_stopped) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                shutdown_channel();
             }
-            else {
-                std::cout << "Channel has shut down.\n";
+        });
+
+        if (standby_group != nullptr && !standby_group->try_acquire()) {
+            std::cout << "Waiting for the primary of standby group '" << Configuration::standby_group << "' to fail...\n";
+            if (standby_group->wait_for_takeover([&]() { return is_quitting.load(); })) {
+                // the takeover completes once the outputs of the channel deliver again
+                channel->set_first_delivery_handler([&]() { standby_group->complete_takeover(); });
             }
-        }, Configuration::num_threads);
+        }
 
+        if (standby_group == nullptr || standby_group->is_primary()) {
+            channel->start(channel_role, [](const std::error_code& ec) {
+                if (ec) {
+                    std::cout << "ERROR: " << ec.message() << ".\n";
+                }
+                else {
+                    std::cout << "Channel has shut down.\n";
+                }
+            }, Configuration::num_threads);
+        }
+
+        has_stopped = true;
         if (shutdown.joinable()) {
             shutdown.join();
         }
+
+        if (standby_group != nullptr && standby_group->is_fenced()) {
+            exit_code = 1;
+        }
     }
     catch (const std::exception& exception)
     {
@@ -1,15 +1,22 @@
 #pragma once
 
+#include <vector>
+#include <memory>
+
 #include <cdi_core_api.h>
 #include <cdi_pool_api.h>
 
 #include "CdiLogger.h"
 #include "NetworkAdapterType.h"
 #include "ChannelRole.h"
+#include "PoolCache.h"
+#include "PixelFormat.h"
 
 namespace CdiTools
 {
     class Channel;
+    class Stream;
+    class ConversionCache;
 
     class Application
     {
@@ -45,8 +52,13 @@ namespace CdiTools
         static int run(ChannelRole channel_role, bool show_channel_config);
 
     private:
-        CdiPoolHandle get_pool_handle(size_t payload_size);
+        PoolCache* get_pool_cache(size_t payload_size);
+        static int get_magazine_size(uint32_t pool_max_items);
         static std::shared_ptr<Channel> configure_channel(ChannelRole channel_role);
+        static void add_format_conversion(std::shared_ptr<Channel> channel, const std::string& connection_name,
+            PixelFormat pixel_format, std::shared_ptr<ConversionCache> conversion_cache);
+        static void add_planned_connections(std::shared_ptr<Channel> channel, const std::vector<std::shared_ptr<Stream>>& streams,
+            ChannelRole channel_role, unsigned int video_buffer_size, unsigned int audio_buffer_size);
         static CdiTools::Application* instance_;
 
         Logger logger_;
@@ -57,6 +69,8 @@ namespace CdiTools
         CdiAdapterHandle adapter_handle_;
         CdiPoolHandle large_buffer_pool_handle_;
         CdiPoolHandle small_buffer_pool_handle_;
+        std::unique_ptr<PoolCache> large_buffer_cache_;
+        std::unique_ptr<PoolCache> small_buffer_cache_;
     };
 }
 
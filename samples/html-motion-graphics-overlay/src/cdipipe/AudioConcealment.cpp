@@ -0,0 +1,100 @@
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+
+#include "AudioConcealment.h"
+#include "AudioStream.h"
+
+namespace
+{
+    // silence is all zeros in every signed PCM format, a single buffer backs all the silent SG entries
+    const int silence_buffer_size = 64 * 1024;
+    const uint8_t silence_buffer[silence_buffer_size] = { 0 };
+
+    inline int64_t get_duration_ns(int64_t samples, int sampling_rate_hz)
+    {
+        return samples * 1000000000 / sampling_rate_hz;
+    }
+}
+
+CdiTools::AudioConcealmentStage::AudioConcealmentStage()
+    : name_{ "audio_concealment" }
+    , next_timestamp_ns_{ 0 }
+    , last_payload_samples_{ 0 }
+    , concealed_samples_{ 0 }
+    , late_payloads_{ 0 }
+    , discontinuities_{ 0 }
+    , logger_{ "AudioConcealment" }
+{
+}
+
+CdiTools::Payload CdiTools::AudioConcealmentStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    auto audio_stream = std::dynamic_pointer_cast<AudioStream>(stream);
+    if (audio_stream == nullptr || payload->timestamp_ns() == 0) return payload;
+
+    int sampling_rate_hz = audio_stream->sampling_rate_hz();
+    int64_t frame_size = static_cast<int64_t>(audio_stream->bytes_per_sample()) * audio_stream->channel_count();
+    int64_t payload_samples = payload->get_size() / frame_size;
+    if (payload_samples == 0) return payload;
+
+    std::lock_guard<std::mutex> lock(gate_);
+    uint64_t timestamp_ns = payload->timestamp_ns();
+    int64_t missing_samples = 0;
+    if (next_timestamp_ns_ != 0) {
+        int64_t offset_ns = static_cast<int64_t>(timestamp_ns - next_timestamp_ns_);
+        int64_t last_payload_ns = get_duration_ns(last_payload_samples_, sampling_rate_hz);
+        if (std::llabs(offset_ns) > max_gap_ns) {
+            discontinuities_++;
+            LOG_WARNING << "Audio stream #" << stream->id() << " timestamps jumped by " << offset_ns / 1000000 << " ms, resynchronizing.";
+        }
+        else if (offset_ns < -last_payload_ns / 2) {
+            // already played out, the samples that fill this period have gone downstream
+            late_payloads_++;
+            return nullptr;
+        }
+        else {
+            // payloads are lost whole, so the gap is rounded to a number of payloads of the last size seen,
+            // which keeps transmit timing jitter from turning into inserted samples
+            int64_t missing_payloads = last_payload_ns > 0 ? (offset_ns + last_payload_ns / 2) / last_payload_ns : 0;
+            missing_samples = missing_payloads * last_payload_samples_;
+        }
+    }
+
+    next_timestamp_ns_ = timestamp_ns + get_duration_ns(payload_samples, sampling_rate_hz);
+    last_payload_samples_ = payload_samples;
+    if (missing_samples == 0) return payload;
+
+    std::vector<CdiSglEntry> entries;
+    for (int64_t remaining = missing_samples * frame_size; remaining > 0; remaining -= silence_buffer_size) {
+        CdiSglEntry entry = { 0 };
+        entry.address_ptr = const_cast<uint8_t*>(silence_buffer);
+        entry.size_in_bytes = static_cast<int>(std::min<int64_t>(remaining, silence_buffer_size));
+        entries.push_back(entry);
+    }
+
+    for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr; sgl_entry_ptr != nullptr; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+        entries.push_back(*sgl_entry_ptr);
+    }
+
+    auto concealed_payload = PayloadData::compose(payload->stream_identifier(), entries, { payload });
+    concealed_payload->metadata().copy_from(payload->metadata());
+    concealed_payload->set_timestamp_ns(timestamp_ns - get_duration_ns(missing_samples, sampling_rate_hz));
+
+    concealed_samples_ += missing_samples;
+    stream->concealment(get_duration_ns(missing_samples, sampling_rate_hz) / 1000);
+    LOG_DEBUG << "Concealed " << missing_samples << " missing samples of audio stream #" << stream->id() << " with silence.";
+
+    return concealed_payload;
+}
+
+std::string CdiTools::AudioConcealmentStage::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << "silent samples inserted: " << concealed_samples_
+        << ", late payloads dropped: " << late_payloads_
+        << ", discontinuities: " << discontinuities_;
+
+    return statistics.str();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+
+#include "IStage.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Keeps a PCM audio stream sample-continuous for the outputs. The origination timestamp of each payload
+    // is compared with the time at which the previous payload ended: a gap of one or more payloads is filled
+    // with silence ahead of the payload, composed into its SG list without copying, and a payload that falls
+    // behind the stream, e.g. a late duplicate, is dropped. Payloads without a timestamp pass through.
+    class AudioConcealmentStage
+        : public IStage
+    {
+    public:
+        AudioConcealmentStage();
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Audio; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Audio; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+
+    private:
+        // gaps longer than this are treated as a restart of the source and are not filled
+        static const int64_t max_gap_ns = 1000000000;
+
+        std::string name_;
+        std::mutex gate_;
+        uint64_t next_timestamp_ns_;
+        int64_t last_payload_samples_;
+        std::atomic<int64_t> concealed_samples_;
+        std::atomic<int64_t> late_payloads_;
+        std::atomic<int64_t> discontinuities_;
+        Logger logger_;
+    };
+}
@@ -21,6 +21,19 @@ namespace CdiTools
         inline PayloadType get_type() override final { return PayloadType::Audio; }
         inline AudioChannelGrouping channel_grouping() { return channel_grouping_; }
         inline AudioSamplingRate sampling_rate() { return sampling_rate_; }
+        inline int bytes_per_sample() { return bytes_per_sample_; }
+        inline int sampling_rate_hz() { return AudioSamplingRate::Rate96kHz == sampling_rate_ ? 96000 : 48000; }
+        inline int channel_count()
+        {
+            switch (channel_grouping_) {
+            case AudioChannelGrouping::Mono: return 1;
+            case AudioChannelGrouping::Surround_5_1: return 6;
+            case AudioChannelGrouping::Surround_7_1: return 8;
+            case AudioChannelGrouping::Surround_22_2: return 24;
+            case AudioChannelGrouping::Sdi: return 16;
+            default: return 2;
+            }
+        }
         inline const std::string& language() { return language_; }
 
     private:
@@ -7,6 +7,7 @@
 #include "AudioStream.h"
 #include "AncillaryStream.h"
 #include "Configuration.h"
+#include "TimeSource.h"
 
 using CdiTools::PayloadType;
 
@@ -137,11 +138,10 @@ PayloadType CdiTools::Cdi::map_payload_type(const CdiBaselineAvmPayloadType payl
 
 void CdiTools::Cdi::set_ptp_timestamp(CdiPtpTimestamp& timestamp)
 {
-    struct timespec time;
+    auto time = TimeSource::instance().now().count();
 
-    CdiCoreGetUtcTime(&time);
-    timestamp.seconds = (uint32_t)time.tv_sec;
-    timestamp.nanoseconds = time.tv_nsec;
+    timestamp.seconds = (uint32_t)(time / 1000000000);
+    timestamp.nanoseconds = (uint32_t)(time % 1000000000);
 }
 
 CdiAvmAudioChannelGrouping CdiTools::Cdi::map_channel_grouping(AudioChannelGrouping channel_grouping)
@@ -347,7 +347,9 @@ void CdiTools::Cdi::initialize_adapter(
     uint32_t small_buffer_pool_max_items,
     CdiAdapterHandle& adapter_handle,
     CdiPoolHandle& large_buffer_pool_handle,
-    CdiPoolHandle& small_buffer_pool_handle)
+    CdiPoolHandle& small_buffer_pool_handle,
+    void*& tx_buffer_ptr,
+    uint64_t& tx_buffer_size)
 {
     // determine buffer pool sizes
     uint32_t large_buffer_size = 0;
@@ -375,6 +377,9 @@ void CdiTools::Cdi::initialize_adapter(
         throw CdiInitializationException(std::string("CDI network adapter initialization failed: ") + CdiCoreStatusToString(rs) + ".");
     }
 
+    tx_buffer_ptr = adapter_data.ret_tx_buffer_ptr;
+    tx_buffer_size = adapter_data.tx_buffer_size_bytes;
+
     void* large_payload_buffer_ptr = adapter_data.ret_tx_buffer_ptr;
     void* small_payload_buffer_ptr = (char*)adapter_data.ret_tx_buffer_ptr + large_buffer_size;
 
@@ -31,7 +31,8 @@ namespace CdiTools
         void initialize_adapter(const char* adapter_ip_address, NetworkAdapterType adapter_type,
             uint32_t large_buffer_pool_item_size, uint32_t large_buffer_pool_max_items,
             uint32_t small_buffer_pool_item_size, uint32_t small_buffer_pool_max_items,
-            CdiAdapterHandle& adapter_handle, CdiPoolHandle& large_buffer_pool_handle, CdiPoolHandle& small_buffer_pool_handle);
+            CdiAdapterHandle& adapter_handle, CdiPoolHandle& large_buffer_pool_handle, CdiPoolHandle& small_buffer_pool_handle,
+            void*& tx_buffer_ptr, uint64_t& tx_buffer_size);
         void shutdown();
         LogLevel map_log_level(CdiLogLevel log_level);
         CdiLogLevel map_log_level(LogLevel log_level);
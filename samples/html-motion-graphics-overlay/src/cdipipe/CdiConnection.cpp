@@ -157,10 +157,18 @@ void CdiTools::CdiConnection::async_transmit(Payload payload, TransmitHandler ha
 #ifdef TRACE_PAYLOADS
     payload_config.core_config_data.core_extra_data.payload_user_data = payload->sequence();
 #else
-    payload_config.core_config_data.core_extra_data.payload_user_data = 0;
+    payload_config.core_config_data.core_extra_data.payload_user_data = payload->metadata().pack_user_data();
 #endif
 
-    Cdi::set_ptp_timestamp(payload_config.core_config_data.core_extra_data.origination_ptp_timestamp);
+    // a payload relayed from another CDI stream keeps its origination time
+    auto& timestamp = payload_config.core_config_data.core_extra_data.origination_ptp_timestamp;
+    if (payload->metadata().has(MetadataSlot::Timestamp)) {
+        timestamp.seconds = static_cast<uint32_t>(payload->timestamp_ns() / 1000000000);
+        timestamp.nanoseconds = static_cast<uint32_t>(payload->timestamp_ns() % 1000000000);
+    }
+    else {
+        Cdi::set_ptp_timestamp(timestamp);
+    }
 
     CdiReturnStatus rs;
     CdiAvmConfig avm_config;
@@ -240,10 +248,10 @@ void CdiTools::CdiConnection::on_payload_received(const CdiAvmRxCbData* cb_data_
     auto payloads_received = ++self->payloads_received_;
     auto status_code = cb_data_ptr->core_cb_data.status_code;
 
-    // create a payload from the SG list received
-    auto payload = PayloadData::create(
-        cb_data_ptr->sgl,
-        cb_data_ptr->avm_extra_data.stream_identifier);
+    // create a payload from the SG list received, which may be empty when the payload was lost
+    auto payload = cb_data_ptr->sgl.sgl_head_ptr != nullptr
+        ? PayloadData::create(cb_data_ptr->sgl, cb_data_ptr->avm_extra_data.stream_identifier)
+        : PayloadData::compose(cb_data_ptr->avm_extra_data.stream_identifier, {}, {});
 
     if (self->receive_callback_.handler == nullptr) {
         self->logger_.error() << "A receive handler has not set. Payload will be dropped.";
@@ -257,7 +265,10 @@ void CdiTools::CdiConnection::on_payload_received(const CdiAvmRxCbData* cb_data_
             ? cb_data_ptr->core_cb_data.err_msg_str : "No message available";
         self->logger_.error() << "Error receiving a payload: " << err_msg
             << ", code: " << status_code << ", total errors: " << payload_errors << ".";
-        self->notify_payload_received(self->receive_callback_.handler, connection_error::receive_error, nullptr);
+        // the payload goes along with the error so that its stream can conceal the loss
+        payload->set_damaged(true);
+        self->notify_payload_received(self->receive_callback_.handler, connection_error::receive_error, payload);
+        return;
     }
 
     // ensure stream is valid
@@ -271,6 +282,10 @@ void CdiTools::CdiConnection::on_payload_received(const CdiAvmRxCbData* cb_data_
     }
 
     if (payload != nullptr) {
+        auto& timestamp = cb_data_ptr->core_cb_data.core_extra_data.origination_ptp_timestamp;
+        payload->set_timestamp_ns(timestamp.seconds * 1000000000ull + timestamp.nanoseconds);
+        payload->metadata().unpack_user_data(cb_data_ptr->core_cb_data.core_extra_data.payload_user_data);
+
         self->logger_.trace() << "CDI received payload #" << payload->stream_identifier() << ":" << payloads_received
 #ifdef TRACE_PAYLOADS
             << " (" << payload->sequence() << ")"
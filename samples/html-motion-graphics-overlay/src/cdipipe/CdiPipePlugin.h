@@ -0,0 +1,102 @@
+#pragma once
+
+/*
+ * cdipipe processing stage plugin interface.
+ *
+ * A plugin is a shared object (.so / .dll) exporting a C function named CDIPIPE_PLUGIN_ENTRY that returns
+ * a description of the stage it implements. The interface is plain C so that plugins can be built with
+ * any compiler. Frames are passed by reference to the payload buffers owned by cdipipe and must not be
+ * retained after process returns. Structures are only ever extended at the end, guarded by api_version:
+ * cdipipe loads plugins built for its own or any earlier API version, and only accesses the fields that
+ * existed in the version a plugin was built for.
+ *
+ * Versions:
+ *   1 - initial interface
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CDIPIPE_PLUGIN_API_VERSION 1
+#define CDIPIPE_PLUGIN_ENTRY "cdipipe_get_stage"
+
+#ifdef _WIN32
+#define CDIPIPE_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define CDIPIPE_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef enum CdiPipePayloadType {
+    kCdiPipePayloadVideo = 0,
+    kCdiPipePayloadAudio = 1,
+    kCdiPipePayloadAncillary = 2
+} CdiPipePayloadType;
+
+typedef enum CdiPipeResult {
+    kCdiPipeForward = 0,        /* pass the (possibly modified in place) frame downstream */
+    kCdiPipeDrop = 1,           /* discard the frame */
+    kCdiPipeReplace = 2,        /* pass the frame returned in 'output' downstream instead */
+    kCdiPipeError = -1          /* processing failed, the frame is counted as an error and discarded */
+} CdiPipeResult;
+
+typedef enum CdiPipeLogLevel {
+    kCdiPipeLogTrace = 0,
+    kCdiPipeLogDebug = 1,
+    kCdiPipeLogInfo = 2,
+    kCdiPipeLogWarning = 3,
+    kCdiPipeLogError = 4
+} CdiPipeLogLevel;
+
+/* contiguous region of a payload, frames may be scattered over several of them */
+typedef struct CdiPipeBuffer {
+    uint8_t* data;
+    uint32_t size;
+} CdiPipeBuffer;
+
+typedef struct CdiPipeFrame {
+    uint16_t stream_identifier;
+    CdiPipePayloadType type;
+    uint32_t sequence;
+    int64_t timestamp_ns;       /* ingest time from the cdipipe reference clock */
+    uint32_t size;              /* payload size in bytes */
+    uint32_t buffer_count;
+    CdiPipeBuffer* buffers;
+    /* video geometry, zero for other payload types */
+    int32_t width;
+    int32_t height;
+    int32_t bytes_per_pixel;
+    int32_t frame_rate_numerator;
+    int32_t frame_rate_denominator;
+} CdiPipeFrame;
+
+typedef void (*CdiPipeTask)(void* argument, int32_t index);
+
+/* services provided by cdipipe, valid for the lifetime of the stage instance */
+typedef struct CdiPipeHost {
+    uint32_t api_version;
+    void* context;
+    /* allocates an output frame from the payload pool with the stream and geometry of 'like', NULL when the pool is exhausted;
+       the frame is owned by cdipipe and released automatically unless returned as the output of process */
+    CdiPipeFrame* (*allocate_frame)(void* context, const CdiPipeFrame* like, uint32_t size);
+    /* runs task(argument, i) for i in [0, count) on the worker pool and returns when all of them complete */
+    void (*parallel_for)(void* context, int32_t count, CdiPipeTask task, void* argument);
+    void (*log)(void* context, CdiPipeLogLevel level, const char* message);
+} CdiPipeHost;
+
+typedef struct CdiPipeStage {
+    uint32_t api_version;
+    const char* name;
+    /* creates a stage instance, 'arguments' is the text following '?' in the plugin specification */
+    void* (*create)(const CdiPipeHost* host, const char* arguments);
+    CdiPipeResult (*process)(void* instance, CdiPipeFrame* frame, CdiPipeFrame** output);
+    void (*destroy)(void* instance);
+} CdiPipeStage;
+
+typedef const CdiPipeStage* (*CdiPipeGetStage)(void);
+
+#ifdef __cplusplus
+}
+#endif
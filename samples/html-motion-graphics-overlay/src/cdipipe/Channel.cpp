@@ -1,5 +1,6 @@
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <cassert>
 
 #include <boost/asio.hpp>
@@ -16,11 +17,39 @@
 #include "AncillaryStream.h"
 #include "Configuration.h"
 #include "Enum.h"
+#include "ThreadScheduling.h"
+#include "FrameClock.h"
+#include "TimeSource.h"
+#include "LatencyMarker.h"
+#include "PluginStage.h"
+#include "Scaler.h"
+#include "StripedTcpConnection.h"
 
 using boost::asio::steady_timer;
 
+namespace
+{
+    // streams without a frame rate of their own, e.g. audio, are paced at the configured video rate
+    std::pair<int, int> get_frame_rate(std::shared_ptr<CdiTools::Stream> stream)
+    {
+        auto video_stream = std::dynamic_pointer_cast<CdiTools::VideoStream>(stream);
+        if (video_stream != nullptr && video_stream->frame_rate_numerator() > 0 && video_stream->frame_rate_denominator() > 0) {
+            return { video_stream->frame_rate_numerator(), video_stream->frame_rate_denominator() };
+        }
+
+        return { CdiTools::Configuration::frame_rate_numerator, CdiTools::Configuration::frame_rate_denominator };
+    }
+
+    // pipeline nodes are instantiated for each stream
+    std::string get_node_name(const std::string& name, uint16_t stream_identifier)
+    {
+        return name + "#" + std::to_string(stream_identifier);
+    }
+}
+
 CdiTools::Channel::Channel(const std::string& name)
     : name_{ name }
+    , pipeline_{ name }
     , logger_{ name }
 {
 }
@@ -39,7 +68,48 @@ void CdiTools::Channel::start(ChannelRole channel_role, ChannelHandler handler,
         << "Large payload pool : " << Configuration::large_buffer_pool_max_items << "\n"
         << "Small payload pool : " << Configuration::small_buffer_pool_max_items;
 
+    configure_scheduling();
+    build_pipeline(handler);
+
+    if (Configuration::io_shards > 0) {
+        io_shards_ = std::make_unique<IoShards>(name_, Configuration::io_shards);
+        for (auto&& connection : connections_) {
+            io_shards_->add_connection(connection->get_name());
+
+            // the sockets of a striped connection are spread over the shards so that they are driven in parallel
+            auto striped_connection = std::dynamic_pointer_cast<StripedTcpConnection>(connection);
+            if (striped_connection != nullptr) {
+                std::vector<std::string> socket_names;
+                for (int i = 0; i < striped_connection->get_stripes(); i++) {
+                    socket_names.push_back(connection->get_name() + "/" + std::to_string(i + 1));
+                    io_shards_->add_connection(socket_names.back());
+                }
+
+                striped_connection->set_socket_dispatcher([this, socket_names](int socket_index, std::function<void()> handler) {
+                    if (io_shards_ != nullptr) {
+                        io_shards_->wrap(socket_names[socket_index], handler)();
+                    }
+                    else {
+                        handler();
+                    }
+                });
+            }
+        }
+
+        io_shards_->start([&]() {
+            std::string description;
+            ThreadScheduling::configure_current_thread(Configuration::scheduling_policy,
+                Configuration::scheduling_priority, Configuration::timer_slack_ns, description);
+            LOG_DEBUG << "IO shard thread scheduling: " << description << ".";
+        });
+
+        rebalance_timer_ = std::make_unique<steady_timer>(io_);
+    }
+
     active_ = std::make_unique<boost::asio::io_context::work>(io_);
+    if (io_shards_ != nullptr) {
+        schedule_rebalance(std::error_code());
+    }
 
     LOG_INFO << "Waiting for channel connections to be ready...";
     open_connections(handler);
@@ -47,7 +117,13 @@ void CdiTools::Channel::start(ChannelRole channel_role, ChannelHandler handler,
     if (thread_pool_size > 1) {
         boost::thread_group pool;
         for (int i = 0; i < thread_pool_size; i++) {
-            pool.create_thread([&]() { io_.run(); });
+            pool.create_thread([&]() {
+                std::string description;
+                ThreadScheduling::configure_current_thread(Configuration::scheduling_policy,
+                    Configuration::scheduling_priority, Configuration::timer_slack_ns, description);
+                LOG_DEBUG << "Channel thread scheduling: " << description << ".";
+                io_.run();
+            });
         }
 
         pool.join_all();
@@ -59,6 +135,111 @@ void CdiTools::Channel::start(ChannelRole channel_role, ChannelHandler handler,
     LOG_INFO << "Channel shut down sucessfully.";
 }
 
+void CdiTools::Channel::configure_scheduling()
+{
+    std::string description;
+    if (Configuration::lock_memory) {
+        if (!ThreadScheduling::lock_memory(description)) {
+            LOG_WARNING << "Failed to lock process memory: " << description << ".";
+        }
+        else {
+            LOG_INFO << "Process memory is locked.";
+        }
+    }
+
+    // channel threads, including those handling the payloads handed off by CDI callbacks, share the same policy
+    if (SchedulingPolicy::Default == Configuration::scheduling_policy && Configuration::timer_slack_ns <= 0) return;
+
+    if (!ThreadScheduling::configure_current_thread(Configuration::scheduling_policy,
+        Configuration::scheduling_priority, Configuration::timer_slack_ns, description)) {
+        LOG_WARNING << "Real-time scheduling is not available, channel threads use: " << description << ".";
+    }
+    else {
+        LOG_INFO << "Channel thread scheduling: " << description << ".";
+    }
+}
+
+void CdiTools::Channel::build_pipeline(ChannelHandler handler)
+{
+    // each stream flows from its source through the stages that accept its payload type to every output connection
+    pipeline_.clear();
+    cut_through_streams_.clear();
+    for (auto&& stream : streams_) {
+        std::string upstream = get_node_name("stream", stream->id());
+        pipeline_.add_source(upstream, stream->get_type());
+
+        // payloads can only be forwarded while they are being received when no stage needs them whole
+        // and every output is a TCP connection, which sends the ranges as they complete
+        bool is_cut_through = Configuration::cut_through && PayloadType::Video == stream->get_type()
+            && LatencyMarkerMode::None == Configuration::latency_marker;
+
+        // branches hang off the end of the inline stages, so they see the frames as every inline stage left them
+        // and no inline stage modifies a frame that a branch may still be reading on another thread
+        std::vector<std::pair<std::string, StageBinding>> branches;
+        auto is_node_name_taken = [&](const std::string& node_name) {
+            return pipeline_.has_node(node_name) || std::any_of(branches.begin(), branches.end(),
+                [&](const std::pair<std::string, StageBinding>& branch) { return branch.first == node_name; });
+        };
+
+        for (auto&& stage : stages_) {
+            auto input_type = stage.stage->get_input_type();
+            if (PayloadType::Unspecified != input_type && stream->get_type() != input_type) continue;
+            if (stage.stream_identifier >= 0 && stage.stream_identifier != stream->id()) continue;
+
+            auto node_name = get_node_name(stage.stage->get_name(), stream->id());
+            for (int i = 2; is_node_name_taken(node_name); i++) {
+                node_name = get_node_name(stage.stage->get_name() + "-" + std::to_string(i), stream->id());
+            }
+
+            is_cut_through = false;
+            if (stage.is_branch) {
+                branches.push_back({ node_name, stage });
+                continue;
+            }
+
+            pipeline_.add_stage(node_name, stage.stage, stage.offload);
+            pipeline_.connect(upstream, node_name);
+            upstream = node_name;
+        }
+
+        // a branch drops what it cannot keep up with rather than hold back the rest of the stream
+        for (auto&& branch : branches) {
+            pipeline_.add_stage(branch.first, branch.second.stage, branch.second.offload, true);
+            pipeline_.connect(upstream, branch.first);
+        }
+
+        for (auto&& connection : get_stream_connections(stream->id(), ConnectionDirection::Out)) {
+            is_cut_through = is_cut_through && ConnectionType::Tcp == connection->get_type();
+
+            // stages bound to an output form a branch of their own in front of its sink
+            std::string output_upstream = upstream;
+            for (auto&& stage : output_stages_[connection->get_name()]) {
+                auto input_type = stage.stage->get_input_type();
+                if (PayloadType::Unspecified != input_type && stream->get_type() != input_type) continue;
+
+                auto node_name = get_node_name(stage.stage->get_name() + "-" + connection->get_name(), stream->id());
+                pipeline_.add_stage(node_name, stage.stage, stage.offload);
+                pipeline_.connect(output_upstream, node_name);
+                output_upstream = node_name;
+                is_cut_through = false;
+            }
+
+            auto node_name = get_node_name(connection->get_name(), stream->id());
+            pipeline_.add_sink(node_name, stream->get_type(), connection,
+                std::bind(&Channel::deliver, this, connection, std::placeholders::_2, std::placeholders::_1, handler));
+            pipeline_.connect(output_upstream, node_name);
+        }
+
+        if (is_cut_through) {
+            LOG_INFO << "Stream #" << stream->id() << " payloads are forwarded as they are received.";
+            cut_through_streams_.insert(stream->id());
+        }
+    }
+
+    pipeline_.validate();
+    pipeline_.show_configuration();
+}
+
 void CdiTools::Channel::open_connections(ChannelHandler handler)
 {
     for (auto&& connection : connections_) {
@@ -86,8 +267,8 @@ void CdiTools::Channel::open_connections(ChannelHandler handler)
                     }
                     else {
                         // set the receive handler for CDI, which starts to receive as soon as the connection is opened
-                        connection->async_receive(
-                            std::bind(&Channel::read_complete, shared_from_this(), connection, std::placeholders::_1, std::placeholders::_2, handler));
+                        connection->async_receive(on_shard<IConnection::ReceiveHandler>(connection,
+                            std::bind(&Channel::read_complete, shared_from_this(), connection, std::placeholders::_1, std::placeholders::_2, handler)));
                     }
 
                     // clear output buffer for any stream associated with this connection
@@ -137,8 +318,9 @@ void CdiTools::Channel::async_read(
         LOG_WARNING << "Error receiving a payload: " << ec.message();
     }
 
+    // a failed allocation throttles the input even when buffers remain cached by other threads
     auto payload_size = connection->get_stream(0)->payload_size();
-    if (Application::get()->get_pool_free_buffer_count(payload_size) == 0) {
+    if (connection_error::no_buffer_space == ec || Application::get()->get_pool_free_buffer_count(payload_size) == 0) {
         if (timer == nullptr) {
             LOG_WARNING << "Memory pool '" << Application::get()->get_pool_name(payload_size) << "' is exhausted"
                 << ". Throttling input '" << connection->get_name() << "'...";
@@ -153,9 +335,21 @@ void CdiTools::Channel::async_read(
         return;
     }
 
+    // hold back the input while its payloads have nowhere to go downstream
+    if (is_congested(connection)) {
+        if (timer == nullptr) {
+            LOG_DEBUG << "Output queues are full. Throttling input '" << connection->get_name() << "'...";
+            timer = std::make_shared<steady_timer>(io_);
+        }
+
+        timer->expires_from_now(std::chrono::milliseconds(2));
+        timer->async_wait(std::bind(&Channel::async_read, shared_from_this(), connection, std::placeholders::_1, handler, timer));
+        return;
+    }
+
     // receiving next payload for this connection
-    connection->async_receive(
-        std::bind(&Channel::read_complete, shared_from_this(), connection, std::placeholders::_1, std::placeholders::_2, handler));
+    connection->async_receive(on_shard<IConnection::ReceiveHandler>(connection,
+        std::bind(&Channel::read_complete, shared_from_this(), connection, std::placeholders::_1, std::placeholders::_2, handler)));
 }
 
 void CdiTools::Channel::read_complete(
@@ -164,41 +358,123 @@ void CdiTools::Channel::read_complete(
     Payload payload,
     ChannelHandler handler)
 {
+    // a payload still being received goes on to the outputs right away only when they can follow its
+    // progress, otherwise it waits until it is complete or aborted
+    auto progress = payload != nullptr ? payload->progress() : nullptr;
+    if (!ec && progress != nullptr && !progress->is_settled() && cut_through_streams_.count(payload->stream_identifier()) == 0) {
+        progress->async_wait(payload->get_size(), [self = shared_from_this(), connection, payload]() {
+            boost::asio::post(self->io_, [self, connection, payload]() { self->push_payload(connection, std::error_code(), payload); });
+        });
+    }
+    else {
+        push_payload(connection, ec, payload);
+    }
+
+    // resume read loop
+    if (connection->get_type() != ConnectionType::Cdi) {
+        async_read(connection, ec, handler);
+    }
+}
+
+void CdiTools::Channel::push_payload(std::shared_ptr<IConnection> connection, const std::error_code& error, Payload payload)
+{
+    // an aborted payload that was held back keeps the bytes received, like a payload received with errors
+    std::error_code ec = error;
+    auto progress = payload != nullptr ? payload->progress() : nullptr;
+    if (!ec && progress != nullptr && PayloadProgress::State::Aborted == progress->get_state()
+        && cut_through_streams_.count(payload->stream_identifier()) == 0) {
+        payload->set_size(static_cast<int>(progress->get_completed_size()));
+        payload->set_damaged(true);
+        ec = make_error_code(connection_error::payload_aborted);
+    }
+
     // determine the payload stream and retrieve its output connections
-    auto stream = get_stream(payload->stream_identifier());
-    auto payloads_received = stream->received_payload();
-    if (ec) {
-        stream->payload_error();
+    auto stream = payload != nullptr ? get_stream(payload->stream_identifier()) : nullptr;
+    if (stream != nullptr) {
+        auto payloads_received = stream->received_payload();
+        if (ec) {
+            stream->payload_error();
+        }
+
+        // keep a sequence number assigned by the transport, e.g. by the sender of a CDI stream
+        if (!payload->metadata().has(MetadataSlot::Sequence)) {
+            payload->metadata().set(MetadataSlot::Sequence, static_cast<uint64_t>(payloads_received));
+        }
+
+        if (!ec && LatencyMarkerMode::None != Configuration::latency_marker) {
+            process_latency_marker(connection, stream, payload, payloads_received);
+        }
+
+        // damaged video payloads are left for the concealment stage to repair or replace
+        if (!ec || (payload->is_damaged() && Configuration::video_concealment && PayloadType::Video == stream->get_type())) {
+            // process the payload and queue it for transmission by each output connection in stream
+            pipeline_.push(get_node_name("stream", stream->id()), payload, stream, static_cast<uint32_t>(payloads_received));
+        }
     }
+}
 
-    if (!ec) {
-        // queue the payload for transmission by each output connection in stream
-        auto connections = get_stream_connections(payload->stream_identifier(), ConnectionDirection::Out);
-        for (auto&& output_connection : connections) {
-            if (ConnectionStatus::Open != output_connection->get_status()) {
-                open_connections(handler);
-                continue;
-            }
+void CdiTools::Channel::deliver(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, Payload payload, ChannelHandler handler)
+{
+    if (ConnectionStatus::Open != connection->get_status()) {
+        open_connections(handler);
+        return;
+    }
 
-            auto& buffer = output_connection->get_buffer();
-            if (buffer.is_full()) {
-                stream->payload_error();
-            }
+    auto& buffer = connection->get_buffer();
+    if (buffer.is_full()) {
+        stream->payload_error();
+    }
 
-            buffer.enqueue(payload);
-            LOG_DEBUG << "Received payload #" << payload->stream_identifier() << ":" << payloads_received
+    buffer.enqueue(payload);
+    LOG_DEBUG << "Received payload #" << payload->stream_identifier() << ":" << stream->get_payloads_received()
 #ifdef TRACE_PAYLOADS
-                << " (" << payload->sequence() << ")"
+        << " (" << payload->sequence() << ")"
 #endif
-                << ", size: " << payload->get_size()
-                << ", queue length/size: " << buffer.size() << "/" << buffer.capacity()
-                << ".";
+        << ", size: " << payload->get_size()
+        << ", queue length/size: " << buffer.size() << "/" << buffer.capacity()
+        << ".";
+}
+
+bool CdiTools::Channel::is_congested(std::shared_ptr<IConnection> connection)
+{
+    for (auto&& stream : get_connection_streams(connection->get_name())) {
+        if (pipeline_.is_congested(get_node_name("stream", stream->id()))) {
+            return true;
         }
     }
 
-    // resume read loop
-    if (connection->get_type() != ConnectionType::Cdi) {
-        async_read(connection, ec, handler);
+    return false;
+}
+
+void CdiTools::Channel::process_latency_marker(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, Payload payload, int sequence)
+{
+    // the overlay stream carries graphics for the compositor, not pictures that reach an output
+    auto video_stream = std::dynamic_pointer_cast<VideoStream>(stream);
+    if (video_stream == nullptr
+        || (!Configuration::overlay_in_pipe.empty() && Configuration::overlay_stream_id == stream->id())) {
+        return;
+    }
+
+    // a marker inserted by an upstream hop is stamped again once read, so each hop measures its own latency
+    uint32_t marker_sequence;
+    std::chrono::nanoseconds timestamp;
+    auto& time_source = TimeSource::instance();
+    if (LatencyMarker::detect(*payload, *video_stream, marker_sequence, timestamp)) {
+        auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(time_source.now() - timestamp).count();
+        stream->latency_sample(latency_us);
+        payload->metadata().set(MetadataSlot::HopLatency, static_cast<uint64_t>(latency_us));
+        LOG_TRACE << "Latency marker #" << marker_sequence << " received from '" << connection->get_name() << "'"
+            << ", latency: " << latency_us << " us.";
+
+        if (LatencyMarkerMode::Remove == Configuration::latency_marker) {
+            LatencyMarker::remove(*payload, *video_stream);
+        }
+        else {
+            LatencyMarker::insert(*payload, *video_stream, marker_sequence, time_source.now());
+        }
+    }
+    else if (LatencyMarkerMode::Insert == Configuration::latency_marker) {
+        LatencyMarker::insert(*payload, *video_stream, static_cast<uint32_t>(sequence), time_source.now());
     }
 }
 
@@ -221,7 +497,19 @@ void CdiTools::Channel::async_write(
     }
 
     auto& buffer = connection->get_buffer();
-    if (buffer.is_empty()) {
+    if (Configuration::genlock) {
+        // a genlocked output emits at most one payload per stream on each tick of the frame clock
+        auto stream = buffer.is_empty() ? connection->get_stream(0) : get_stream(buffer.front()->stream_identifier());
+        auto frame_rate = get_frame_rate(stream);
+        auto& frame_clock = FrameClock::instance();
+        if (buffer.is_empty() || !claim_frame_tick(connection, stream, frame_clock.get_current_tick(frame_rate.first, frame_rate.second))) {
+            frame_clock.async_wait(frame_rate.first, frame_rate.second, io_, [self = shared_from_this(), connection, handler](uint64_t) {
+                self->async_write(connection, std::error_code(), handler);
+            });
+            return;
+        }
+    }
+    else if (buffer.is_empty()) {
         if (timer == nullptr) {
             timer = std::make_shared<steady_timer>(io_);
         }
@@ -244,7 +532,19 @@ void CdiTools::Channel::async_write(
 
     connection->async_transmit(
         payload,
-        std::bind(&Channel::write_complete, shared_from_this(), connection, stream, std::placeholders::_1, handler));
+        on_shard<IConnection::TransmitHandler>(connection,
+            std::bind(&Channel::write_complete, shared_from_this(), connection, stream, std::placeholders::_1, handler)));
+}
+
+bool CdiTools::Channel::claim_frame_tick(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, uint64_t tick)
+{
+    std::lock_guard<std::mutex> lock(frame_ticks_gate_);
+    auto& next_tick = frame_ticks_[{ connection->get_name(), stream->id() }];
+    if (tick < next_tick) return false;
+
+    next_tick = tick + 1;
+
+    return true;
 }
 
 void CdiTools::Channel::write_complete(
@@ -274,12 +574,21 @@ void CdiTools::Channel::write_complete(
 #endif
             << ", queue length/size: " << buffer.size() - 1 << "/" << buffer.capacity()
             << ".";
+
+        if (first_delivery_handler_) {
+            std::call_once(first_delivery_, first_delivery_handler_);
+        }
     }
 
     buffer.pop_front();
     async_write(connection, ec, handler);
 }
 
+void CdiTools::Channel::set_first_delivery_handler(std::function<void()> handler)
+{
+    first_delivery_handler_ = handler;
+}
+
 void CdiTools::Channel::shutdown()
 {
     if (active_ == nullptr) return;
@@ -299,13 +608,32 @@ void CdiTools::Channel::shutdown()
         }
     }
 
+    if (rebalance_timer_ != nullptr) {
+        rebalance_timer_->cancel();
+    }
+
     io_.stop();
 
+    if (io_shards_ != nullptr) {
+        io_shards_->stop();
+    }
+
     for (auto&& connection : connections_) {
         connection->get_buffer().clear();
     }
 }
 
+void CdiTools::Channel::schedule_rebalance(const std::error_code& ec)
+{
+    static const auto rebalance_interval = std::chrono::seconds(1);
+
+    if (ec || active_ == nullptr) return;
+
+    io_shards_->rebalance(rebalance_interval);
+    rebalance_timer_->expires_from_now(rebalance_interval);
+    rebalance_timer_->async_wait(std::bind(&Channel::schedule_rebalance, shared_from_this(), std::placeholders::_1));
+}
+
 std::shared_ptr<CdiTools::IConnection> CdiTools::Channel::add_input(ConnectionType connection_type, const std::string& name,
     const std::string& host_name, unsigned short port_number, ConnectionMode connection_mode, int buffer_size)
 {
@@ -395,6 +723,61 @@ void CdiTools::Channel::map_stream(uint16_t stream_identifier, const std::string
     channel_map_.insert({ connection_name, stream_identifier });
 }
 
+void CdiTools::Channel::impair_connections(ConnectionDirection direction, const ImpairmentProfile& profile)
+{
+    // a profile without impairments leaves the connections untouched, with no decorator in their path
+    if (!profile.is_enabled()) return;
+
+    unsigned int seed = profile.seed;
+    for (auto&& connection : connections_) {
+        if (ConnectionDirection::Both == direction || connection->get_direction() == direction) {
+            // derive a different but reproducible sequence for each connection
+            ImpairmentProfile connection_profile = profile;
+            connection_profile.seed = seed++;
+            connection = std::make_shared<ImpairedConnection>(connection, connection_profile, io_);
+        }
+    }
+}
+
+void CdiTools::Channel::add_stage(std::shared_ptr<IStage> stage, bool offload, int stream_identifier)
+{
+    stages_.push_back({ stage, offload, stream_identifier, false });
+}
+
+void CdiTools::Channel::add_output_stage(const std::string& connection_name, std::shared_ptr<IStage> stage, bool offload)
+{
+    output_stages_[connection_name].push_back({ stage, offload, -1, false });
+}
+
+std::shared_ptr<CdiTools::Stream> CdiTools::Channel::add_rendition(
+    uint16_t source_stream_identifier, uint16_t stream_identifier, int frame_width, int frame_height, ScalingFilter filter)
+{
+    auto source_stream = std::dynamic_pointer_cast<VideoStream>(get_stream(source_stream_identifier));
+    if (source_stream == nullptr) {
+        throw InvalidConfigurationException(std::string("Cannot add rendition stream #" + std::to_string(stream_identifier)
+            + ". Stream #" + std::to_string(source_stream_identifier) + " is not a video stream."));
+    }
+
+    auto rendition_stream = std::static_pointer_cast<VideoStream>(add_video_stream(stream_identifier, frame_width, frame_height,
+        source_stream->bytes_per_pixel(), source_stream->frame_rate_numerator(), source_stream->frame_rate_denominator()));
+
+    // the scaler branches off the source stream on the worker pool, so its outputs never wait for it; scaled
+    // frames enter the pipeline at the source of the rendition stream and are routed like received payloads
+    auto scaler = std::make_shared<ScalerStage>(source_stream, rendition_stream, filter,
+        [this, rendition_stream](Payload payload) {
+            auto payloads_received = rendition_stream->received_payload();
+            pipeline_.push(get_node_name("stream", rendition_stream->id()), payload, rendition_stream, static_cast<uint32_t>(payloads_received));
+        });
+    stages_.push_back({ scaler, true, source_stream_identifier, true });
+
+    return rendition_stream;
+}
+
+void CdiTools::Channel::add_plugin(const std::string& specification)
+{
+    add_stage(std::make_shared<PluginStage>(specification));
+}
+
 void CdiTools::Channel::validate_configuration()
 {
     for (auto&& connection : connections_) {
@@ -450,6 +833,36 @@ void CdiTools::Channel::show_status()
             << ", Tx payloads: " << stream->get_payloads_transmitted()
             << ", errors: " << stream->get_payload_errors()
             << ", queues: " << queue_length.str();
+
+        if (stream->get_latency_samples() > 0) {
+            LOG_INFO << "Stream #" << stream->id()
+                << " - latency markers: " << stream->get_latency_samples()
+                << ", average: " << stream->get_average_latency_us() << " us"
+                << ", max: " << stream->get_max_latency_us() << " us";
+        }
+
+        if (stream->get_concealments() > 0) {
+            LOG_INFO << "Stream #" << stream->id()
+                << " - concealments: " << stream->get_concealments()
+                << ", concealed: " << stream->get_concealed_us() / 1000 << " ms";
+        }
+    }
+
+    for (auto&& connection : connections_) {
+        auto statistics = connection->get_statistics();
+        if (!statistics.empty()) {
+            LOG_INFO << "Connection '" << connection->get_name() << "' - " << statistics;
+        }
+    }
+
+    pipeline_.show_status();
+
+    if (MetadataSlab::instance().get_exhausted_count() > 0) {
+        LOG_WARNING << "Payload metadata slab exhausted " << MetadataSlab::instance().get_exhausted_count() << " times, overflow values were dropped.";
+    }
+
+    if (io_shards_ != nullptr) {
+        io_shards_->show_status();
     }
 }
 
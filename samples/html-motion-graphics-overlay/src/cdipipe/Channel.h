@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <mutex>
+#include <functional>
 
 #include <boost/bimap.hpp>
 #include <boost/bimap/multiset_of.hpp>
@@ -12,6 +15,11 @@
 #include "ChannelRole.h"
 #include "Connection.h"
 #include "Stream.h"
+#include "ImpairedConnection.h"
+#include "IStage.h"
+#include "Pipeline.h"
+#include "IoShards.h"
+#include "ScalingFilter.h"
 
 namespace CdiTools
 {
@@ -36,6 +44,16 @@ namespace CdiTools
         std::shared_ptr<Stream> add_audio_stream(uint16_t stream_identifier, AudioChannelGrouping channel_grouping, AudioSamplingRate audio_sampling_rate, int bytes_per_sample, const std::string& language);
         std::shared_ptr<Stream> add_ancillary_stream(uint16_t stream_identifier);
         void map_stream(uint16_t stream_identifier, const std::string& connection_name);
+        void impair_connections(ConnectionDirection direction, const ImpairmentProfile& profile);
+        // the stage is applied to the given stream or, by default, to every stream carrying its input type
+        void add_stage(std::shared_ptr<IStage> stage, bool offload = false, int stream_identifier = -1);
+        // adds a stage that only processes the payloads delivered to the given output connection
+        void add_output_stage(const std::string& connection_name, std::shared_ptr<IStage> stage, bool offload = false);
+        // adds a video stream made of the frames of another video stream scaled to a different resolution
+        std::shared_ptr<Stream> add_rendition(uint16_t source_stream_identifier, uint16_t stream_identifier, int frame_width, int frame_height, ScalingFilter filter);
+        void add_plugin(const std::string& specification);
+        // the handler is called once, when the first payload is transmitted by any output connection
+        void set_first_delivery_handler(std::function<void()> handler);
         inline const std::string& get_name() { return name_; }
         inline bool is_active() { return active_ != nullptr; }
         void validate_configuration();
@@ -47,18 +65,54 @@ namespace CdiTools
         std::vector<std::shared_ptr<IConnection>> get_stream_connections(uint16_t stream_identifier, ConnectionDirection direction = ConnectionDirection::Both);
         std::vector<std::shared_ptr<Stream>> get_connection_streams(const std::string& connection_name);
         void show_stream_connections(uint16_t stream_identifier, ConnectionDirection direction = ConnectionDirection::Both);
+        void configure_scheduling();
+        void build_pipeline(ChannelHandler handler);
+        void deliver(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, Payload payload, ChannelHandler handler);
+        bool is_congested(std::shared_ptr<IConnection> connection);
         void open_connections(ChannelHandler handler);
         void async_read(std::shared_ptr<IConnection> connection, const std::error_code& ec, ChannelHandler handler, std::shared_ptr<boost::asio::steady_timer> timer = nullptr);
+        void process_latency_marker(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, Payload payload, int sequence);
         void read_complete(std::shared_ptr<IConnection> connection, const std::error_code& ec, Payload payload, ChannelHandler handler);
+        void push_payload(std::shared_ptr<IConnection> connection, const std::error_code& ec, Payload payload);
         void async_write(std::shared_ptr<IConnection> connection, const std::error_code& ec, ChannelHandler handler, std::shared_ptr<boost::asio::steady_timer> timer = nullptr);
+        bool claim_frame_tick(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, uint64_t tick);
         void write_complete(std::shared_ptr<IConnection> connection, std::shared_ptr<Stream> stream, const std::error_code& ec, ChannelHandler handler);
+        void schedule_rebalance(const std::error_code& ec);
+
+        // runs a connection handler on the io shard of the connection, when shards are enabled
+        template <typename THandler>
+        THandler on_shard(std::shared_ptr<IConnection> connection, THandler handler)
+        {
+            return io_shards_ != nullptr ? THandler(io_shards_->wrap(connection->get_name(), handler)) : handler;
+        }
 
         std::string name_;
         boost::asio::io_context io_;
         std::unique_ptr<boost::asio::io_context::work> active_;
         std::vector<std::shared_ptr<IConnection>> connections_;
         std::vector<std::shared_ptr<Stream>> streams_;
+        struct StageBinding
+        {
+            std::shared_ptr<IStage> stage;
+            bool offload;
+            int stream_identifier;
+            // the stage hangs off the end of the inline stages of the stream as a branch of its own, which its
+            // outputs do not wait for
+            bool is_branch;
+        };
+
+        std::vector<StageBinding> stages_;
+        std::map<std::string, std::vector<StageBinding>> output_stages_;
+        // streams whose payloads reach the outputs before they are completely received
+        std::set<uint16_t> cut_through_streams_;
+        Pipeline pipeline_;
+        std::unique_ptr<IoShards> io_shards_;
+        std::unique_ptr<boost::asio::steady_timer> rebalance_timer_;
         boost::bimap<boost::bimaps::multiset_of<std::string>, boost::bimaps::multiset_of<uint16_t>> channel_map_;
+        std::mutex frame_ticks_gate_;
+        std::map<std::pair<std::string, uint16_t>, uint64_t> frame_ticks_;
+        std::function<void()> first_delivery_handler_;
+        std::once_flag first_delivery_;
         Logger logger_;
     };
 }
@@ -3,5 +3,6 @@
 enum_map<CdiTools::ChannelType> CdiTools::channel_type_map{
     { "Tcp", ChannelType::Tcp },
     { "Cdi", ChannelType::Cdi },
-    { "CdiStream", ChannelType::CdiStream }
+    { "CdiStream", ChannelType::CdiStream },
+    { "CdiAuto", ChannelType::CdiAuto }
 };
@@ -8,7 +8,8 @@ namespace CdiTools
     {
         Tcp,
         Cdi,
-        CdiStream
+        CdiStream,
+        CdiAuto
     };
 
     extern enum_map<ChannelType> channel_type_map;
@@ -0,0 +1,231 @@
+#include <vector>
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define USE_AVX2
+#define AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define USE_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#include "ColorConversion.h"
+
+using namespace CdiTools::ColorConversion;
+
+namespace
+{
+    // components of a pair of rows in 16-bit planes, chroma planes hold the sums of each 2x2 block
+    struct RowPlanes
+    {
+        std::vector<int16_t> red[2];
+        std::vector<int16_t> green[2];
+        std::vector<int16_t> blue[2];
+        std::vector<int16_t> chroma_red;
+        std::vector<int16_t> chroma_green;
+        std::vector<int16_t> chroma_blue;
+
+        void resize(int width)
+        {
+            // padded to whole vectors so the last iteration of a SIMD loop stays in bounds
+            size_t size = (static_cast<size_t>(width) + 31) & ~size_t(31);
+            for (int i = 0; i < 2; i++) {
+                red[i].resize(size);
+                green[i].resize(size);
+                blue[i].resize(size);
+            }
+
+            chroma_red.resize(size / 2 + 16);
+            chroma_green.resize(size / 2 + 16);
+            chroma_blue.resize(size / 2 + 16);
+        }
+    };
+
+    void unpack_rows(const uint8_t* source_row0, const uint8_t* source_row1, const PackedLayout& layout, int width, RowPlanes& planes)
+    {
+        const uint8_t* rows[2] = { source_row0, source_row1 };
+        for (int i = 0; i < 2; i++) {
+            const uint8_t* source = rows[i];
+            for (int x = 0; x < width; x++, source += layout.bytes_per_pixel) {
+                planes.red[i][x] = source[layout.red];
+                planes.green[i][x] = source[layout.green];
+                planes.blue[i][x] = source[layout.blue];
+            }
+        }
+
+        // an odd last column is paired with itself
+        int chroma_width = (width + 1) / 2;
+        for (int x = 0; x < chroma_width; x++) {
+            int x0 = 2 * x;
+            int x1 = std::min(x0 + 1, width - 1);
+            planes.chroma_red[x] = static_cast<int16_t>((planes.red[0][x0] + planes.red[0][x1] + planes.red[1][x0] + planes.red[1][x1] + 2) >> 2);
+            planes.chroma_green[x] = static_cast<int16_t>((planes.green[0][x0] + planes.green[0][x1] + planes.green[1][x0] + planes.green[1][x1] + 2) >> 2);
+            planes.chroma_blue[x] = static_cast<int16_t>((planes.blue[0][x0] + planes.blue[0][x1] + planes.blue[1][x0] + planes.blue[1][x1] + 2) >> 2);
+        }
+    }
+
+    inline uint8_t get_luma(int red, int green, int blue)
+    {
+        return static_cast<uint8_t>(((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16);
+    }
+
+    inline uint8_t get_chroma_u(int red, int green, int blue)
+    {
+        return static_cast<uint8_t>(((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128);
+    }
+
+    inline uint8_t get_chroma_v(int red, int green, int blue)
+    {
+        return static_cast<uint8_t>(((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128);
+    }
+
+    void convert_luma(const RowPlanes& planes, int row, uint8_t* y_row, int first, int width)
+    {
+        for (int x = first; x < width; x++) {
+            y_row[x] = get_luma(planes.red[row][x], planes.green[row][x], planes.blue[row][x]);
+        }
+    }
+
+    void convert_chroma(const RowPlanes& planes, uint8_t* u_row, uint8_t* v_row, int first, int chroma_width)
+    {
+        for (int x = first; x < chroma_width; x++) {
+            uint8_t u = get_chroma_u(planes.chroma_red[x], planes.chroma_green[x], planes.chroma_blue[x]);
+            uint8_t v = get_chroma_v(planes.chroma_red[x], planes.chroma_green[x], planes.chroma_blue[x]);
+            if (v_row != nullptr) {
+                u_row[x] = u;
+                v_row[x] = v;
+            }
+            else {
+                u_row[2 * x] = u;
+                u_row[2 * x + 1] = v;
+            }
+        }
+    }
+
+#ifdef USE_AVX2
+    // weighted sum of 16 pixels, the luma weights are positive and their sum fits unsigned 16-bit lanes
+    AVX2_TARGET inline __m256i weigh(__m256i red, __m256i green, __m256i blue, int16_t red_weight, int16_t green_weight, int16_t blue_weight)
+    {
+        __m256i sum = _mm256_mullo_epi16(red, _mm256_set1_epi16(red_weight));
+        sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(green, _mm256_set1_epi16(green_weight)));
+        sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(blue, _mm256_set1_epi16(blue_weight)));
+
+        return _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+    }
+
+    AVX2_TARGET inline __m256i load(const std::vector<int16_t>& plane, int x)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(plane.data() + x));
+    }
+
+    // returns the number of pixels converted, the rest is left to the scalar code
+    AVX2_TARGET int convert_luma_avx2(const RowPlanes& planes, int row, uint8_t* y_row, int width)
+    {
+        const __m256i offset = _mm256_set1_epi16(16);
+        int x = 0;
+        for (; x + 32 <= width; x += 32) {
+            __m256i low = _mm256_add_epi16(_mm256_srli_epi16(weigh(load(planes.red[row], x), load(planes.green[row], x), load(planes.blue[row], x), 66, 129, 25), 8), offset);
+            __m256i high = _mm256_add_epi16(_mm256_srli_epi16(weigh(load(planes.red[row], x + 16), load(planes.green[row], x + 16), load(planes.blue[row], x + 16), 66, 129, 25), 8), offset);
+            // packing works within 128-bit lanes, the permutation puts the pixels back in order
+            __m256i luma = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y_row + x), luma);
+        }
+
+        return x;
+    }
+
+    AVX2_TARGET int convert_chroma_avx2(const RowPlanes& planes, uint8_t* u_row, uint8_t* v_row, int chroma_width)
+    {
+        const __m256i offset = _mm256_set1_epi16(128);
+        int x = 0;
+        for (; x + 16 <= chroma_width; x += 16) {
+            __m256i red = load(planes.chroma_red, x);
+            __m256i green = load(planes.chroma_green, x);
+            __m256i blue = load(planes.chroma_blue, x);
+            __m256i u = _mm256_add_epi16(_mm256_srai_epi16(weigh(red, green, blue, -38, -74, 112), 8), offset);
+            __m256i v = _mm256_add_epi16(_mm256_srai_epi16(weigh(red, green, blue, 112, -94, -18), 8), offset);
+            if (v_row != nullptr) {
+                __m256i packed_u = _mm256_permute4x64_epi64(_mm256_packus_epi16(u, u), _MM_SHUFFLE(3, 1, 2, 0));
+                __m256i packed_v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(u_row + x), _mm256_castsi256_si128(packed_u));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(v_row + x), _mm256_castsi256_si128(packed_v));
+            }
+            else {
+                // both values are within 0-255, each 16-bit lane becomes a UV byte pair
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(u_row + 2 * x), _mm256_or_si256(u, _mm256_slli_epi16(v, 8)));
+            }
+        }
+
+        return x;
+    }
+#endif
+}
+
+PackedLayout CdiTools::ColorConversion::get_packed_layout(PixelFormat pixel_format)
+{
+    switch (pixel_format) {
+    case PixelFormat::Bgr24: return { 2, 1, 0, -1, 3 };
+    case PixelFormat::Rgba: return { 0, 1, 2, 3, 4 };
+    case PixelFormat::Bgra: return { 2, 1, 0, 3, 4 };
+    default: return { 0, 1, 2, -1, 3 };
+    }
+}
+
+void CdiTools::ColorConversion::convert_packed_row(const uint8_t* source, const PackedLayout& source_layout, uint8_t* target, const PackedLayout& target_layout, int width)
+{
+    for (int x = 0; x < width; x++, source += source_layout.bytes_per_pixel, target += target_layout.bytes_per_pixel) {
+        target[target_layout.red] = source[source_layout.red];
+        target[target_layout.green] = source[source_layout.green];
+        target[target_layout.blue] = source[source_layout.blue];
+        if (target_layout.alpha >= 0) {
+            target[target_layout.alpha] = source_layout.alpha >= 0 ? source[source_layout.alpha] : 255;
+        }
+    }
+}
+
+void CdiTools::ColorConversion::convert_yuv420_rows(const uint8_t* source_row0, const uint8_t* source_row1, const PackedLayout& source_layout, int width,
+    uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row)
+{
+    static const bool is_avx2_available = has_avx2();
+
+    thread_local RowPlanes planes;
+    planes.resize(width);
+    unpack_rows(source_row0, source_row1, source_layout, width, planes);
+
+    int chroma_width = (width + 1) / 2;
+    int luma_done[2] = { 0, 0 };
+    int chroma_done = 0;
+#ifdef USE_AVX2
+    if (is_avx2_available) {
+        luma_done[0] = convert_luma_avx2(planes, 0, y_row0, width);
+        luma_done[1] = y_row1 != nullptr ? convert_luma_avx2(planes, 1, y_row1, width) : 0;
+        chroma_done = convert_chroma_avx2(planes, u_row, v_row, chroma_width);
+    }
+#endif
+
+    convert_luma(planes, 0, y_row0, luma_done[0], width);
+    if (y_row1 != nullptr) {
+        convert_luma(planes, 1, y_row1, luma_done[1], width);
+    }
+
+    convert_chroma(planes, u_row, v_row, chroma_done, chroma_width);
+}
+
+bool CdiTools::ColorConversion::has_avx2()
+{
+#if defined(USE_AVX2) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool has_os_support = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+
+    return has_os_support && (info[1] & (1 << 5)) != 0;
+#elif defined(USE_AVX2)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PixelFormat.h"
+
+namespace CdiTools
+{
+    // Pixel kernels used by the format conversion stage.
+    namespace ColorConversion
+    {
+        // byte offsets of the red, green, blue and alpha components of a packed pixel, -1 when absent
+        struct PackedLayout
+        {
+            int red;
+            int green;
+            int blue;
+            int alpha;
+            int bytes_per_pixel;
+        };
+
+        PackedLayout get_packed_layout(PixelFormat pixel_format);
+        void convert_packed_row(const uint8_t* source, const PackedLayout& source_layout, uint8_t* target, const PackedLayout& target_layout, int width);
+
+        // Converts a pair of packed rows to two rows of luma and one row of 2x2 subsampled chroma, with BT.601
+        // limited range coefficients as used by default by FFmpeg. Chroma goes either to separate U and V rows
+        // or, when v_row is nullptr, to a row of interleaved UV pairs as in NV12. Uses AVX2 when available.
+        void convert_yuv420_rows(const uint8_t* source_row0, const uint8_t* source_row1, const PackedLayout& source_layout, int width,
+            uint8_t* y_row0, uint8_t* y_row1, uint8_t* u_row, uint8_t* v_row);
+
+        bool has_avx2();
+    }
+}
@@ -87,7 +87,8 @@ bool CommandLine::parse(int argc, char* argv[])
                 return false;
             }
 
-            if (i + 1 < argc && *argv[i + 1] != '-') {
+            // a lone dash is a value, e.g. standard input
+            if (i + 1 < argc && (*argv[i + 1] != '-' || std::string(argv[i + 1]) == "-")) {
                 if (!option->second->set_value(argv[++i])) {
                     show_usage();
                     std::cout << "ERROR: Invalid value '" << argv[i] << "' found for option '" << option_name << "'.\n\n";
@@ -132,6 +133,15 @@ bool Option<bool>::set_value(const std::string& option_value)
     return true;
 }
 
+// string values are taken verbatim, they may contain spaces, e.g. a command line
+template<>
+bool Option<std::string>::set_value(const std::string& option_value)
+{
+    value_ = option_value;
+
+    return true;
+}
+
 //CommandLine& CommandLine::add_validator(const std::string& name, Validator validator)
 //{
 //    validators_.insert(std::make_pair(name, validator));
@@ -60,6 +60,9 @@ bool Option<T>::set_value(const std::string& option_value)
 template<>
 bool Option<bool>::set_value(const std::string& option_value);
 
+template<>
+bool Option<std::string>::set_value(const std::string& option_value);
+
 template <typename T>
 void Option<T>::write(std::ostream& os) const
 {
@@ -0,0 +1,441 @@
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define USE_SSE2
+#endif
+
+#include "Compositor.h"
+#include "PayloadRange.h"
+#include "VideoStream.h"
+#include "LatencyMarker.h"
+#include "Errors.h"
+
+namespace
+{
+    using Coverage = CdiTools::OverlayFrame::Coverage;
+
+    // exact rounded division by 255 of the weighted sum of both pixels
+    inline uint8_t blend(unsigned int source, unsigned int target, unsigned int alpha)
+    {
+        unsigned int value = source * alpha + target * (255 - alpha) + 128;
+        return static_cast<uint8_t>((value + (value >> 8)) >> 8);
+    }
+
+    template <int BytesPerPixel>
+    void copy_span(uint8_t* target, const uint8_t* source, int pixels)
+    {
+        for (int i = 0; i < pixels; i++, target += BytesPerPixel, source += 4) {
+            target[0] = source[0];
+            target[1] = source[1];
+            target[2] = source[2];
+        }
+    }
+
+    template <int BytesPerPixel>
+    void blend_span(uint8_t* target, const uint8_t* source, int pixels)
+    {
+        for (int i = 0; i < pixels; i++, target += BytesPerPixel, source += 4) {
+            unsigned int alpha = source[3];
+            if (alpha == 0) continue;
+
+            if (alpha == 255) {
+                target[0] = source[0];
+                target[1] = source[1];
+                target[2] = source[2];
+            }
+            else {
+                target[0] = blend(source[0], target[0], alpha);
+                target[1] = blend(source[1], target[1], alpha);
+                target[2] = blend(source[2], target[2], alpha);
+            }
+        }
+    }
+
+    // composites the tiles intersecting one overlay row, where 'first' and 'last' are overlay columns
+    template <int BytesPerPixel>
+    void composite_row(const CdiTools::OverlayFrame& overlay, int tile_row, const uint8_t* source, uint8_t* target,
+        int first, int last, uint64_t* tile_counts)
+    {
+        const int tile_size = CdiTools::OverlayFrame::tile_size;
+        for (int x = first; x < last;) {
+            int tile_column = x / tile_size;
+            int span_end = std::min(last, (tile_column + 1) * tile_size);
+            auto coverage = overlay.get_coverage(tile_column, tile_row);
+            if (Coverage::Opaque == coverage) {
+                copy_span<BytesPerPixel>(target + (x - first) * BytesPerPixel, source + x * 4, span_end - x);
+            }
+            else if (Coverage::Mixed == coverage) {
+                blend_span<BytesPerPixel>(target + (x - first) * BytesPerPixel, source + x * 4, span_end - x);
+            }
+
+            if (tile_counts != nullptr) {
+                tile_counts[static_cast<int>(coverage)]++;
+            }
+
+            x = span_end;
+        }
+    }
+
+    // index of the first pixel in [first, last) with a non-zero alpha, or last when there is none
+    int find_first_visible(const uint8_t* row, int first, int last)
+    {
+        int x = first;
+#ifdef USE_SSE2
+        const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 16 <= last; x += 16) {
+            const __m128i* pixels = reinterpret_cast<const __m128i*>(row + x * 4);
+            __m128i alpha = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(pixels), _mm_loadu_si128(pixels + 1)),
+                _mm_or_si128(_mm_loadu_si128(pixels + 2), _mm_loadu_si128(pixels + 3)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(alpha, alpha_mask), zero)) != 0xFFFF) break;
+        }
+#endif
+        for (; x < last; x++) {
+            if (row[x * 4 + 3] != 0) return x;
+        }
+
+        return last;
+    }
+
+    // index of the last pixel in [first, last) with a non-zero alpha, or -1 when there is none
+    int find_last_visible(const uint8_t* row, int first, int last)
+    {
+        int x = last;
+#ifdef USE_SSE2
+        const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        const __m128i zero = _mm_setzero_si128();
+        for (; x - 16 >= first; x -= 16) {
+            const __m128i* pixels = reinterpret_cast<const __m128i*>(row + (x - 16) * 4);
+            __m128i alpha = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(pixels), _mm_loadu_si128(pixels + 1)),
+                _mm_or_si128(_mm_loadu_si128(pixels + 2), _mm_loadu_si128(pixels + 3)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(alpha, alpha_mask), zero)) != 0xFFFF) break;
+        }
+#endif
+        for (x--; x >= first; x--) {
+            if (row[x * 4 + 3] != 0) return x;
+        }
+
+        return -1;
+    }
+
+    // bounding box of the pixels with a non-zero alpha; rows only scan the columns outside the box
+    // found so far, plus its interior until the first visible pixel
+    CdiTools::OverlayRegion find_visible_region(const uint8_t* pixels, int width, int height)
+    {
+        int left = width;
+        int right = 0;
+        int top = height;
+        int bottom = 0;
+        for (int y = 0; y < height; y++) {
+            const uint8_t* row = pixels + static_cast<size_t>(y) * width * 4;
+            int first = find_first_visible(row, 0, left);
+            bool is_visible = first < left;
+            left = std::min(left, first);
+
+            int last = find_last_visible(row, std::max(right, left), width);
+            if (last >= 0) {
+                right = last + 1;
+                is_visible = true;
+            }
+
+            if (!is_visible && left < right) {
+                is_visible = find_first_visible(row, left, right) < right;
+            }
+
+            if (is_visible) {
+                top = std::min(top, y);
+                bottom = y + 1;
+            }
+        }
+
+        return bottom > top ? CdiTools::OverlayRegion{ left, top, right - left, bottom - top } : CdiTools::OverlayRegion{ 0, 0, 0, 0 };
+    }
+}
+
+CdiTools::OverlayFrame::OverlayFrame(Payload payload, const uint8_t* pixels, int window_width, const OverlayRegion& region)
+    : payload_{ payload }
+    , pixels_{ nullptr }
+    , stride_{ static_cast<size_t>(window_width) * bytes_per_pixel }
+    , region_(region)
+    , tile_columns_{ (region.width + tile_size - 1) / tile_size }
+    , tile_counts_{ 0, 0, 0 }
+{
+    const uint8_t* origin = pixels + region.top * stride_ + static_cast<size_t>(region.left) * bytes_per_pixel;
+    if (region.width < window_width || payload == nullptr) {
+        // a cropped region is copied so that the much larger payload buffer goes back to the pool
+        size_t row_size = static_cast<size_t>(region.width) * bytes_per_pixel;
+        storage_.resize(row_size * region.height);
+        for (int y = 0; y < region.height; y++) {
+            std::copy(origin + y * stride_, origin + y * stride_ + row_size, storage_.data() + y * row_size);
+        }
+
+        pixels_ = storage_.data();
+        stride_ = row_size;
+        payload_ = nullptr;
+    }
+    else {
+        pixels_ = origin;
+    }
+
+    int width = region.width;
+    int height = region.height;
+    int tile_rows = (height + tile_size - 1) / tile_size;
+    coverage_.resize(static_cast<size_t>(tile_columns_) * tile_rows);
+    visible_tile_rows_.resize(tile_rows);
+
+    // alpha values of each tile are folded with OR and AND, zero means transparent and 255 opaque
+    std::vector<uint8_t> any_alpha(tile_columns_);
+    std::vector<uint8_t> all_alpha(tile_columns_);
+    for (int tile_row = 0; tile_row < tile_rows; tile_row++) {
+        std::fill(any_alpha.begin(), any_alpha.end(), 0);
+        std::fill(all_alpha.begin(), all_alpha.end(), 255);
+        for (int y = tile_row * tile_size; y < std::min(height, (tile_row + 1) * tile_size); y++) {
+            const uint8_t* row = get_row(y);
+            for (int tile_column = 0; tile_column < tile_columns_; tile_column++) {
+                uint8_t any = 0;
+                uint8_t all = 255;
+                for (int x = tile_column * tile_size; x < std::min(width, (tile_column + 1) * tile_size); x++) {
+                    any |= row[x * bytes_per_pixel + 3];
+                    all &= row[x * bytes_per_pixel + 3];
+                }
+
+                any_alpha[tile_column] |= any;
+                all_alpha[tile_column] &= all;
+            }
+        }
+
+        bool visible = false;
+        for (int tile_column = 0; tile_column < tile_columns_; tile_column++) {
+            auto coverage = any_alpha[tile_column] == 0 ? Coverage::Transparent
+                : all_alpha[tile_column] == 255 ? Coverage::Opaque : Coverage::Mixed;
+            coverage_[tile_row * tile_columns_ + tile_column] = coverage;
+            tile_counts_[static_cast<int>(coverage)]++;
+            visible = visible || Coverage::Transparent != coverage;
+        }
+
+        visible_tile_rows_[tile_row] = visible;
+    }
+}
+
+CdiTools::CompositorStage::CompositorStage(int left, int top, bool preserve_latency_marker)
+    : name_{ "compositor" }
+    , left_{ left }
+    , top_{ top }
+    , preserve_latency_marker_{ preserve_latency_marker }
+    , overlays_received_{ 0 }
+    , tiles_skipped_{ 0 }
+    , tiles_copied_{ 0 }
+    , tiles_blended_{ 0 }
+{
+}
+
+void CdiTools::CompositorStage::set_overlay(std::shared_ptr<const OverlayFrame> overlay)
+{
+    std::lock_guard<std::mutex> lock(overlay_gate_);
+    overlay_ = overlay;
+    overlays_received_++;
+}
+
+std::shared_ptr<const CdiTools::OverlayFrame> CdiTools::CompositorStage::get_overlay()
+{
+    std::lock_guard<std::mutex> lock(overlay_gate_);
+    return overlay_;
+}
+
+CdiTools::Payload CdiTools::CompositorStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    auto overlay = get_overlay();
+    auto video_stream = std::dynamic_pointer_cast<VideoStream>(stream);
+    if (overlay == nullptr || video_stream == nullptr) return payload;
+
+    int bytes_per_pixel = video_stream->bytes_per_pixel();
+    int frame_width = video_stream->frame_width();
+    if ((bytes_per_pixel != 3 && bytes_per_pixel != 4)
+        || payload->get_size() < frame_width * video_stream->frame_height() * bytes_per_pixel) {
+        return payload;
+    }
+
+    // overlay columns and rows that fall inside the frame
+    int left = left_ + overlay->left();
+    int top = top_ + overlay->top();
+    int first_column = std::max(0, -left);
+    int last_column = std::min(overlay->width(), frame_width - left);
+    int first_row = std::max(0, -top);
+    if (preserve_latency_marker_) {
+        // keep the marker stamped into the top rows of the frame readable downstream
+        first_row = std::max(first_row, LatencyMarker::get_marker_rows(*video_stream) - top);
+    }
+    int last_row = std::min(overlay->height(), video_stream->frame_height() - top);
+    if (first_column >= last_column || first_row >= last_row) return payload;
+
+    thread_local std::vector<uint8_t> row_buffer;
+    size_t row_size = static_cast<size_t>(last_column - first_column) * bytes_per_pixel;
+    uint64_t tile_counts[3] = { 0, 0, 0 };
+    for (int y = first_row; y < last_row; y++) {
+        int tile_row = y / OverlayFrame::tile_size;
+        if (!overlay->is_tile_row_visible(tile_row)) {
+            y = std::min(last_row, (tile_row + 1) * OverlayFrame::tile_size) - 1;
+            continue;
+        }
+
+        // rows split across SGL entries are composited in a scratch buffer
+        size_t offset = (static_cast<size_t>(top + y) * frame_width + left + first_column) * bytes_per_pixel;
+        uint8_t* target = PayloadRange::get_contiguous(*payload, offset, row_size);
+        if (target == nullptr) {
+            row_buffer.resize(row_size);
+            PayloadRange::read(*payload, offset, row_buffer.data(), row_size);
+        }
+
+        // tiles are counted once, on their first row inside the frame
+        bool first_tile_row = y == first_row || y % OverlayFrame::tile_size == 0;
+        uint8_t* row = target != nullptr ? target : row_buffer.data();
+        if (bytes_per_pixel == 3) {
+            composite_row<3>(*overlay, tile_row, overlay->get_row(y), row, first_column, last_column, first_tile_row ? tile_counts : nullptr);
+        }
+        else {
+            composite_row<4>(*overlay, tile_row, overlay->get_row(y), row, first_column, last_column, first_tile_row ? tile_counts : nullptr);
+        }
+
+        if (target == nullptr) {
+            PayloadRange::write(*payload, offset, row_buffer.data(), row_size);
+        }
+    }
+
+    tiles_skipped_ += tile_counts[static_cast<int>(OverlayFrame::Coverage::Transparent)];
+    tiles_copied_ += tile_counts[static_cast<int>(OverlayFrame::Coverage::Opaque)];
+    tiles_blended_ += tile_counts[static_cast<int>(OverlayFrame::Coverage::Mixed)];
+
+    // the composited region and its coverage travel with the frame for the stages and outputs downstream
+    auto& metadata = payload->metadata();
+    metadata.set(MetadataSlot::CropLeft, static_cast<uint64_t>(left + first_column));
+    metadata.set(MetadataSlot::CropTop, static_cast<uint64_t>(top + first_row));
+    metadata.set(MetadataSlot::CropWidth, static_cast<uint64_t>(last_column - first_column));
+    metadata.set(MetadataSlot::CropHeight, static_cast<uint64_t>(last_row - first_row));
+    metadata.set_value(MetadataKeys::TransparentTiles, tile_counts[static_cast<int>(OverlayFrame::Coverage::Transparent)]);
+    metadata.set_value(MetadataKeys::OpaqueTiles, tile_counts[static_cast<int>(OverlayFrame::Coverage::Opaque)]);
+    metadata.set_value(MetadataKeys::MixedTiles, tile_counts[static_cast<int>(OverlayFrame::Coverage::Mixed)]);
+
+    return payload;
+}
+
+std::string CdiTools::CompositorStage::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << "overlays: " << overlays_received_
+        << ", tiles skipped: " << tiles_skipped_
+        << ", copied: " << tiles_copied_
+        << ", blended: " << tiles_blended_;
+
+    return statistics.str();
+}
+
+CdiTools::OverlayInputStage::OverlayInputStage(std::shared_ptr<CompositorStage> compositor, int width, int height, bool autocrop)
+    : name_{ "overlay" }
+    , compositor_{ compositor }
+    , width_{ width }
+    , height_{ height }
+    , autocrop_{ autocrop }
+    , region_{ 0, 0, 0, 0 }
+    , shrink_count_{ 0 }
+    , cropped_area_{ 0 }
+    , overlays_received_{ 0 }
+    , logger_{ "Overlay" }
+{
+}
+
+CdiTools::Payload CdiTools::OverlayInputStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    size_t size = static_cast<size_t>(width_) * height_ * OverlayFrame::bytes_per_pixel;
+    if (static_cast<size_t>(payload->get_size()) < size) {
+        LOG_WARNING << "Overlay frame #" << sequence << " is incomplete, size: " << payload->get_size() << ".";
+        ec = make_error_code(connection_error::receive_error);
+        return nullptr;
+    }
+
+    thread_local std::vector<uint8_t> frame_buffer;
+    const uint8_t* pixels = PayloadRange::get_contiguous(*payload, 0, size);
+    bool is_scattered = pixels == nullptr;
+    if (is_scattered) {
+        frame_buffer.resize(size);
+        PayloadRange::read(*payload, 0, frame_buffer.data(), size);
+        pixels = frame_buffer.data();
+    }
+
+    OverlayRegion region{ 0, 0, width_, height_ };
+    if (autocrop_) {
+        region = update_region(find_visible_region(pixels, width_, height_));
+    }
+
+    auto overlay = std::make_shared<OverlayFrame>(is_scattered ? nullptr : payload, pixels, width_, region);
+    overlays_received_++;
+    cropped_area_ += static_cast<int64_t>(region.width) * region.height;
+    LOG_TRACE << "Overlay frame #" << sequence << " - region: " << region.width << "x" << region.height
+        << "+" << region.left << "+" << region.top
+        << ", opaque tiles: " << overlay->get_tile_count(OverlayFrame::Coverage::Opaque)
+        << ", mixed: " << overlay->get_tile_count(OverlayFrame::Coverage::Mixed)
+        << ", transparent: " << overlay->get_tile_count(OverlayFrame::Coverage::Transparent) << ".";
+    compositor_->set_overlay(overlay);
+
+    // the overlay is consumed here, it does not continue to any output
+    return nullptr;
+}
+
+CdiTools::OverlayRegion CdiTools::OverlayInputStage::update_region(const OverlayRegion& visible_region)
+{
+    // snapping to the tile grid absorbs small movements of the graphic
+    const int tile_size = OverlayFrame::tile_size;
+    OverlayRegion region{ 0, 0, 0, 0 };
+    if (visible_region.width > 0 && visible_region.height > 0) {
+        region.left = visible_region.left / tile_size * tile_size;
+        region.top = visible_region.top / tile_size * tile_size;
+        region.width = std::min(width_, (visible_region.left + visible_region.width + tile_size - 1) / tile_size * tile_size) - region.left;
+        region.height = std::min(height_, (visible_region.top + visible_region.height + tile_size - 1) / tile_size * tile_size) - region.top;
+    }
+
+    bool is_empty = region.width == 0 || region.height == 0;
+    bool is_current_empty = region_.width == 0 || region_.height == 0;
+    bool is_inside = is_empty || (!is_current_empty
+        && region.left >= region_.left && region.top >= region_.top
+        && region.left + region.width <= region_.left + region_.width
+        && region.top + region.height <= region_.top + region_.height);
+
+    if (!is_inside) {
+        // grow at once so that no visible pixel is ever cut off
+        if (!is_current_empty) {
+            int right = std::max(region.left + region.width, region_.left + region_.width);
+            int bottom = std::max(region.top + region.height, region_.top + region_.height);
+            region.left = std::min(region.left, region_.left);
+            region.top = std::min(region.top, region_.top);
+            region.width = right - region.left;
+            region.height = bottom - region.top;
+        }
+
+        region_ = region;
+        shrink_count_ = 0;
+    }
+    else if (region.width * region.height < region_.width * region_.height) {
+        if (++shrink_count_ >= shrink_delay) {
+            region_ = region;
+            shrink_count_ = 0;
+        }
+    }
+    else {
+        shrink_count_ = 0;
+    }
+
+    return region_;
+}
+
+std::string CdiTools::OverlayInputStage::get_statistics() const
+{
+    int64_t overlays_received = overlays_received_;
+    int64_t window_area = static_cast<int64_t>(width_) * height_;
+
+    std::ostringstream statistics;
+    statistics << "overlays: " << overlays_received
+        << ", average region: " << (overlays_received > 0 && window_area > 0 ? 100 * cropped_area_ / (overlays_received * window_area) : 100)
+        << "% of window";
+
+    return statistics.str();
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+
+#include "IStage.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // rectangle of an overlay window, in pixels
+    struct OverlayRegion
+    {
+        int left;
+        int top;
+        int width;
+        int height;
+    };
+
+    // RGBA overlay picture with a coverage map that classifies each tile as fully transparent, fully
+    // opaque or mixed. The map is built once when the overlay arrives so that compositing cost scales
+    // with the visible area of the overlay rather than with the size of the video frame. The frame may
+    // hold only a region of the overlay window, which is then copied out so the payload buffer can
+    // return to the pool.
+    class OverlayFrame
+    {
+    public:
+        enum class Coverage : uint8_t { Transparent, Opaque, Mixed };
+        static const int tile_size = 16;
+        static const int bytes_per_pixel = 4;
+
+        OverlayFrame(Payload payload, const uint8_t* pixels, int window_width, const OverlayRegion& region);
+
+        inline int left() const { return region_.left; }
+        inline int top() const { return region_.top; }
+        inline int width() const { return region_.width; }
+        inline int height() const { return region_.height; }
+        inline Coverage get_coverage(int tile_column, int tile_row) const { return coverage_[tile_row * tile_columns_ + tile_column]; }
+        inline bool is_tile_row_visible(int tile_row) const { return visible_tile_rows_[tile_row]; }
+        inline const uint8_t* get_row(int y) const { return pixels_ + static_cast<size_t>(y) * stride_; }
+        inline int get_tile_count(Coverage coverage) const { return tile_counts_[static_cast<int>(coverage)]; }
+
+    private:
+        Payload payload_;
+        std::vector<uint8_t> storage_;
+        const uint8_t* pixels_;
+        size_t stride_;
+        OverlayRegion region_;
+        int tile_columns_;
+        std::vector<Coverage> coverage_;
+        std::vector<bool> visible_tile_rows_;
+        int tile_counts_[3];
+    };
+
+    // Blends the most recent overlay frame onto each video payload at a fixed position. Transparent
+    // tiles are skipped, opaque tiles are copied and only mixed tiles are alpha blended. When asked to, the
+    // compositor leaves the rows of the latency marker untouched.
+    class CompositorStage
+        : public IStage
+    {
+    public:
+        CompositorStage(int left, int top, bool preserve_latency_marker);
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Video; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Video; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+        void set_overlay(std::shared_ptr<const OverlayFrame> overlay);
+
+    private:
+        std::shared_ptr<const OverlayFrame> get_overlay();
+
+        std::string name_;
+        int left_;
+        int top_;
+        bool preserve_latency_marker_;
+        std::mutex overlay_gate_;
+        std::shared_ptr<const OverlayFrame> overlay_;
+        std::atomic_int overlays_received_;
+        std::atomic<uint64_t> tiles_skipped_;
+        std::atomic<uint64_t> tiles_copied_;
+        std::atomic<uint64_t> tiles_blended_;
+    };
+
+    // Consumes the payloads of the overlay stream, turning each one into an overlay frame for the compositor.
+    // With auto-cropping, only the bounding box of the visible pixels is kept. The box grows as soon as the
+    // graphic does but shrinks only after staying smaller for a while, so it does not flap with animations.
+    class OverlayInputStage
+        : public IStage
+    {
+    public:
+        OverlayInputStage(std::shared_ptr<CompositorStage> compositor, int width, int height, bool autocrop);
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Video; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Video; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+
+    private:
+        OverlayRegion update_region(const OverlayRegion& visible_region);
+
+        // number of consecutive frames the graphic must stay smaller before the region shrinks
+        static const int shrink_delay = 30;
+
+        std::string name_;
+        std::shared_ptr<CompositorStage> compositor_;
+        int width_;
+        int height_;
+        bool autocrop_;
+        OverlayRegion region_;
+        int shrink_count_;
+        std::atomic<int64_t> cropped_area_;
+        std::atomic<int64_t> overlays_received_;
+        Logger logger_;
+    };
+}
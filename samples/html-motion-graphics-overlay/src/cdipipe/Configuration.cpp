@@ -11,6 +11,41 @@ std::string Configuration::log_file;
 ChannelType Configuration::channel_type{ ChannelType::CdiStream };
 bool Configuration::inline_handlers{ false };
 int Configuration::num_threads{ 1 };
+int Configuration::io_shards{ 0 };
+bool Configuration::tcp_autotune{ true };
+bool Configuration::cut_through{ false };
+int Configuration::tcp_stripes{ 1 };
+bool Configuration::genlock{ false };
+bool Configuration::genlock_utc{ false };
+TimeSourceType Configuration::time_source{ TimeSourceType::Utc };
+std::string Configuration::ptp_device{ "/dev/ptp0" };
+LatencyMarkerMode Configuration::latency_marker{ LatencyMarkerMode::None };
+std::string Configuration::standby_group;
+int Configuration::standby_timeout{ 40 };
+
+// real-time settings
+SchedulingPolicy Configuration::scheduling_policy{ SchedulingPolicy::Default };
+int Configuration::scheduling_priority{ 50 };
+int Configuration::timer_slack_ns{ 0 };
+bool Configuration::lock_memory{ false };
+int Configuration::numa_node{ -1 };
+
+// network impairment settings
+std::string Configuration::rx_impairment;
+std::string Configuration::tx_impairment;
+
+// processing stage settings
+std::string Configuration::plugins;
+int Configuration::offload_queue_size{ 4 };
+
+// overlay settings
+std::string Configuration::overlay_in_pipe;
+uint16_t Configuration::overlay_stream_id = 3;
+int Configuration::overlay_width = 0;
+int Configuration::overlay_height = 0;
+int Configuration::overlay_left = 0;
+int Configuration::overlay_top = 0;
+bool Configuration::overlay_autocrop{ true };
 
 // CDI settings
 NetworkAdapterType Configuration::adapter_type{ NetworkAdapterType::SocketLibFabric };
@@ -18,6 +53,7 @@ std::string Configuration::local_ip{ "127.0.0.1" };
 std::string Configuration::remote_ip{ "127.0.0.1" };
 int Configuration::buffer_delay{ 0 };
 int Configuration::tx_timeout{ 0 };
+double Configuration::cdi_connection_bandwidth{ 12000 };
 
 // CloudWatch settings
 #ifdef ENABLE_CLOUDWATCH
@@ -31,6 +67,7 @@ const uint32_t Configuration::large_buffer_pool_item_size = 1920 * 1080 * 3;
 const uint32_t Configuration::small_buffer_pool_item_size = 2 * 2304;
 unsigned int Configuration::large_buffer_pool_max_items = 40;
 unsigned int Configuration::small_buffer_pool_max_items = 60;
+int Configuration::pool_magazine_size = -1;
 
 // input/output port configurations
 unsigned short Configuration::port_number = 2000;
@@ -38,6 +75,10 @@ unsigned short Configuration::video_in_port = 1000;
 unsigned short Configuration::audio_in_port = video_in_port + 1;
 unsigned short Configuration::video_out_port = 3000;
 unsigned short Configuration::audio_out_port = video_out_port + 1;
+std::string Configuration::video_in_pipe;
+std::string Configuration::audio_in_pipe;
+std::string Configuration::video_out_pipe;
+std::string Configuration::audio_out_pipe;
 
 // video configuration settings
 uint16_t Configuration::video_stream_id = 1;
@@ -46,6 +87,13 @@ int Configuration::bytes_per_pixel = 3;
 int Configuration::frame_height = 534;
 int Configuration::frame_rate_numerator = 24;
 int Configuration::frame_rate_denominator = 1;
+PixelFormat Configuration::pixel_format = PixelFormat::Rgb24;
+std::string Configuration::video_out_format;
+std::string Configuration::video_outputs;
+bool Configuration::video_concealment{ false };
+std::string Configuration::video_renditions;
+uint16_t Configuration::rendition_stream_id = 11;
+ScalingFilter Configuration::scaling_filter = ScalingFilter::Bicubic;
 
 // audio configuration settings
 bool Configuration::disable_audio{ false };
@@ -54,3 +102,4 @@ AudioChannelGrouping Configuration::audio_channel_grouping = AudioChannelGroupin
 AudioSamplingRate Configuration::audio_sampling_rate = AudioSamplingRate::Rate48kHz;
 int Configuration::audio_bytes_per_sample = 2;
 std::string Configuration::audio_stream_language = "en";
+bool Configuration::audio_concealment{ false };
@@ -5,6 +5,11 @@
 #include "ChannelRole.h"
 #include "NetworkAdapterType.h"
 #include "StreamOptions.h"
+#include "SchedulingPolicy.h"
+#include "TimeSourceType.h"
+#include "LatencyMarkerMode.h"
+#include "PixelFormat.h"
+#include "ScalingFilter.h"
 
 namespace CdiTools
 {
@@ -18,6 +23,41 @@ namespace CdiTools
         static ChannelType channel_type;
         static bool inline_handlers;
         static int num_threads;
+        static int io_shards;
+        static bool tcp_autotune;
+        static bool cut_through;
+        static int tcp_stripes;
+        static bool genlock;
+        static bool genlock_utc;
+        static TimeSourceType time_source;
+        static std::string ptp_device;
+        static LatencyMarkerMode latency_marker;
+        static std::string standby_group;
+        static int standby_timeout;
+
+        // real-time settings
+        static SchedulingPolicy scheduling_policy;
+        static int scheduling_priority;
+        static int timer_slack_ns;
+        static bool lock_memory;
+        static int numa_node;
+
+        // network impairment settings
+        static std::string rx_impairment;
+        static std::string tx_impairment;
+
+        // processing stage settings
+        static std::string plugins;
+        static int offload_queue_size;
+
+        // overlay settings
+        static std::string overlay_in_pipe;
+        static uint16_t overlay_stream_id;
+        static int overlay_width;
+        static int overlay_height;
+        static int overlay_left;
+        static int overlay_top;
+        static bool overlay_autocrop;
 
         // CDI settings
         static NetworkAdapterType adapter_type;
@@ -25,6 +65,7 @@ namespace CdiTools
         static std::string remote_ip;
         static int buffer_delay;
         static int tx_timeout;
+        static double cdi_connection_bandwidth;
 
         // CloudWatch settings
 #ifdef ENABLE_CLOUDWATCH
@@ -38,6 +79,7 @@ namespace CdiTools
         static const uint32_t small_buffer_pool_item_size;
         static unsigned int large_buffer_pool_max_items;
         static unsigned int small_buffer_pool_max_items;
+        static int pool_magazine_size;
 
         // input/output port configurations
         static unsigned short port_number;
@@ -45,6 +87,10 @@ namespace CdiTools
         static unsigned short audio_in_port;
         static unsigned short video_out_port;
         static unsigned short audio_out_port;
+        static std::string video_in_pipe;
+        static std::string audio_in_pipe;
+        static std::string video_out_pipe;
+        static std::string audio_out_pipe;
 
         // video configuration settings
         static uint16_t video_stream_id;
@@ -53,6 +99,13 @@ namespace CdiTools
         static int frame_height;
         static int frame_rate_numerator;
         static int frame_rate_denominator;
+        static PixelFormat pixel_format;
+        static std::string video_out_format;
+        static std::string video_outputs;
+        static bool video_concealment;
+        static std::string video_renditions;
+        static uint16_t rendition_stream_id;
+        static ScalingFilter scaling_filter;
 
         // audio configuration settings
         static bool disable_audio;
@@ -61,5 +114,6 @@ namespace CdiTools
         static AudioSamplingRate audio_sampling_rate;
         static int audio_bytes_per_sample;
         static std::string audio_stream_language;
+        static bool audio_concealment;
     };
 }
@@ -5,6 +5,8 @@
 
 #include "TcpConnection.h"
 #include "CdiConnection.h"
+#include "StripedTcpConnection.h"
+#include "PipeConnection.h"
 
 using namespace boost::asio;
 using namespace boost::asio::ip;
@@ -78,6 +80,14 @@ std::shared_ptr<CdiTools::IConnection> CdiTools::Connection::get_connection(Conn
     case ConnectionType::Tcp:
         connection = std::make_shared<TcpConnection>(name, host_name, port_number, connection_mode, connection_direction, buffer_size, io);
         break;
+    case ConnectionType::StripedTcp:
+        connection = std::make_shared<StripedTcpConnection>(name, host_name, port_number, connection_mode, connection_direction, buffer_size, Configuration::tcp_stripes, io);
+        break;
+#ifndef _WIN32
+    case ConnectionType::Pipe:
+        connection = std::make_shared<PipeConnection>(name, host_name, connection_mode, connection_direction, buffer_size, io);
+        break;
+#endif
     default:
         throw InvalidConfigurationException(std::string("Failed to create unsupported connection type " + std::to_string(static_cast<int>(connection_type)) + "."));
     }
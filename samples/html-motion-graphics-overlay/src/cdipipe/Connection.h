@@ -27,6 +27,7 @@ namespace CdiTools
         void add_stream(std::shared_ptr<Stream> stream) override;
         std::shared_ptr<Stream> get_stream(uint16_t stream_identifier) override;
         PayloadBuffer& get_buffer() override;
+        inline std::string get_statistics() const override { return std::string(); }
 
         static std::shared_ptr<IConnection> get_connection(ConnectionType connection_type, const std::string& name, 
             const std::string& host_name, unsigned short port_number, ConnectionMode connection_mode,
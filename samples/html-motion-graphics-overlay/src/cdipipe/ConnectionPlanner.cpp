@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "ConnectionPlanner.h"
+#include "VideoStream.h"
+#include "AudioStream.h"
+#include "Configuration.h"
+
+namespace
+{
+    // streams above this fraction of the connection limit are not packed with other streams
+    const double dedicated_fraction = 0.1;
+}
+
+double CdiTools::ConnectionPlanner::get_bandwidth_mbps(std::shared_ptr<Stream> stream)
+{
+    auto video_stream = std::dynamic_pointer_cast<VideoStream>(stream);
+    if (video_stream != nullptr && video_stream->frame_rate_denominator() > 0) {
+        return 8.0 * video_stream->frame_width() * video_stream->frame_height() * video_stream->bytes_per_pixel()
+            * video_stream->frame_rate_numerator() / video_stream->frame_rate_denominator() / 1e6;
+    }
+
+    auto audio_stream = std::dynamic_pointer_cast<AudioStream>(stream);
+    if (audio_stream != nullptr) {
+        return 8.0 * audio_stream->sampling_rate_hz() * audio_stream->channel_count() * audio_stream->bytes_per_sample() / 1e6;
+    }
+
+    // other payloads are sent at most once per video frame
+    return Configuration::frame_rate_denominator > 0
+        ? 8.0 * stream->payload_size() * Configuration::frame_rate_numerator / Configuration::frame_rate_denominator / 1e6 : 0;
+}
+
+std::vector<CdiTools::PlannedConnection> CdiTools::ConnectionPlanner::plan(const std::vector<std::shared_ptr<Stream>>& streams,
+    double connection_limit_mbps, const std::string& name_suffix, unsigned short first_port_number)
+{
+    std::vector<std::pair<std::shared_ptr<Stream>, double>> demands;
+    for (auto&& stream : streams) {
+        demands.push_back({ stream, get_bandwidth_mbps(stream) });
+    }
+
+    // decreasing bandwidth, ties broken by stream identifier so that both ends agree
+    std::sort(demands.begin(), demands.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first->id() < b.first->id();
+    });
+
+    std::vector<PlannedConnection> connections;
+    for (auto&& demand : demands) {
+        bool is_dedicated = demand.second >= connection_limit_mbps * dedicated_fraction;
+        auto connection = is_dedicated ? connections.end()
+            : std::find_if(connections.begin(), connections.end(), [&](const PlannedConnection& candidate) {
+                return !candidate.is_dedicated && candidate.bandwidth_mbps + demand.second <= connection_limit_mbps;
+            });
+
+        if (connection == connections.end()) {
+            connections.push_back({ "", 0, {}, 0, is_dedicated });
+            connection = connections.end() - 1;
+        }
+
+        connection->stream_identifiers.push_back(demand.first->id());
+        connection->bandwidth_mbps += demand.second;
+    }
+
+    for (size_t i = 0; i < connections.size(); i++) {
+        connections[i].name = "cdi" + std::to_string(i + 1) + name_suffix;
+        connections[i].port_number = static_cast<unsigned short>(first_port_number + i);
+    }
+
+    return connections;
+}
+
+void CdiTools::ConnectionPlanner::show_plan(const std::vector<PlannedConnection>& connections, double connection_limit_mbps)
+{
+    std::cout << "# CDI connection plan (limit: " << connection_limit_mbps << " Mbps)\n";
+    for (auto&& connection : connections) {
+        std::cout << "  [" << std::setw(12) << std::left << connection.name << "] "
+            << "port: " << connection.port_number
+            << ", bandwidth: " << std::fixed << std::setprecision(1) << connection.bandwidth_mbps << " Mbps"
+            << (connection.is_dedicated ? ", dedicated" : ", shared")
+            << (connection.bandwidth_mbps > connection_limit_mbps ? " (exceeds limit)" : "")
+            << ", streams:";
+        for (auto stream_identifier : connection.stream_identifiers) {
+            std::cout << " " << stream_identifier;
+        }
+
+        std::cout << "\n";
+    }
+
+    std::cout << std::defaultfloat << "\n";
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Stream.h"
+
+namespace CdiTools
+{
+    // CDI connection carrying one or more streams, as assigned by the connection planner.
+    struct PlannedConnection
+    {
+        std::string name;
+        unsigned short port_number;
+        std::vector<uint16_t> stream_identifiers;
+        double bandwidth_mbps;
+        bool is_dedicated;
+    };
+
+    // Assigns streams to CDI connections from their bandwidth. High-rate streams, those above a tenth of the
+    // connection limit, get a connection of their own. Low-rate streams such as audio and ancillary data
+    // are packed together, first fit by decreasing bandwidth, without exceeding the limit. Both ends of a
+    // channel derive the same plan from the same stream configuration.
+    namespace ConnectionPlanner
+    {
+        double get_bandwidth_mbps(std::shared_ptr<Stream> stream);
+        std::vector<PlannedConnection> plan(const std::vector<std::shared_ptr<Stream>>& streams, double connection_limit_mbps,
+            const std::string& name_suffix, unsigned short first_port_number);
+        void show_plan(const std::vector<PlannedConnection>& connections, double connection_limit_mbps);
+    }
+}
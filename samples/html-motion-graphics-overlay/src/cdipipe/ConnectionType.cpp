@@ -2,5 +2,7 @@
 
 enum_map<CdiTools::ConnectionType> CdiTools::connection_type_map{
     { "Tcp", ConnectionType::Tcp },
-    { "Cdi", ConnectionType::Cdi }
+    { "Cdi", ConnectionType::Cdi },
+    { "StripedTcp", ConnectionType::StripedTcp },
+    { "Pipe", ConnectionType::Pipe }
 };
@@ -7,7 +7,9 @@ namespace CdiTools
     enum class ConnectionType
     {
         Tcp,
-        Cdi
+        Cdi,
+        StripedTcp,
+        Pipe
     };
 
     extern enum_map<ConnectionType> connection_type_map;
@@ -25,6 +25,8 @@ std::string CdiTools::Internal::connection_category::message(int ev) const
         return "stream identifier is invalid";
     case connection_error::bad_configuration:
         return "configuration is invalid";
+    case connection_error::payload_aborted:
+        return "payload reception was aborted";
     default:
         return "unknown connection error";
     }
@@ -41,6 +43,7 @@ std::error_condition CdiTools::Internal::connection_category::default_error_cond
         return make_error_condition(std::errc::already_connected);
     case connection_error::receive_error:
     case connection_error::transmit_error:
+    case connection_error::payload_aborted:
         return make_error_condition(std::errc::io_error);
     case connection_error::no_buffer_space:
         return make_error_condition(std::errc::no_buffer_space);
@@ -15,7 +15,8 @@ namespace CdiTools
         transmit_error,
         no_buffer_space,
         bad_stream_identifier,
-        bad_configuration
+        bad_configuration,
+        payload_aborted
     };
 
     std::error_code make_error_code(CdiTools::connection_error ec);
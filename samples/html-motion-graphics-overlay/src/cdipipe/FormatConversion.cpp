@@ -0,0 +1,176 @@
+#include <cctype>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+#include "FormatConversion.h"
+#include "ColorConversion.h"
+#include "PayloadRange.h"
+#include "ThreadPool.h"
+#include "VideoStream.h"
+#include "Errors.h"
+
+namespace
+{
+    // rows converted by each task of a parallel conversion, even so that chroma rows are not shared
+    const int band_height = 16;
+}
+
+CdiTools::ConversionCache::ConversionCache(size_t capacity)
+    : capacity_{ capacity }
+    , conversions_{ 0 }
+    , shared_{ 0 }
+{
+}
+
+CdiTools::Payload CdiTools::ConversionCache::get(Payload source, PixelFormat target_format, std::function<Payload()> convert)
+{
+    std::promise<Payload> promise;
+    std::shared_future<Payload> pending_result;
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        // entries of frames released by every output can never be asked for again
+        entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry& entry) { return entry.source.expired(); }), entries_.end());
+
+        auto entry = std::find_if(entries_.begin(), entries_.end(), [&](const Entry& entry) {
+            return entry.source_ptr == source.get() && entry.target_format == target_format;
+        });
+
+        if (entry != entries_.end()) {
+            pending_result = entry->result;
+        }
+        else {
+            entries_.push_back({ source.get(), source, target_format, promise.get_future().share() });
+            if (entries_.size() > capacity_) {
+                entries_.pop_front();
+            }
+        }
+    }
+
+    if (pending_result.valid()) {
+        shared_++;
+        return pending_result.get();
+    }
+
+    // converted outside the lock, outputs asking for other formats or frames are not held up
+    conversions_++;
+    Payload result;
+    try {
+        result = convert();
+    }
+    catch (...) {
+        promise.set_value(nullptr);
+        throw;
+    }
+
+    promise.set_value(result);
+
+    return result;
+}
+
+CdiTools::FormatConversionStage::FormatConversionStage(std::shared_ptr<ConversionCache> cache, PixelFormat source_format, PixelFormat target_format)
+    : name_{ "convert-" + enum_name(pixel_format_map, target_format) }
+    , cache_{ cache }
+    , source_format_{ source_format }
+    , target_format_{ target_format }
+    , frames_converted_{ 0 }
+    , conversion_errors_{ 0 }
+    , logger_{ "FormatConversion" }
+{
+    std::transform(name_.begin(), name_.end(), name_.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+}
+
+CdiTools::Payload CdiTools::FormatConversionStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    auto video_stream = std::dynamic_pointer_cast<VideoStream>(stream);
+    if (video_stream == nullptr || source_format_ == target_format_) return payload;
+
+    int width = video_stream->frame_width();
+    int height = video_stream->frame_height();
+    if (payload->get_size() < get_frame_size(source_format_, width, height)) return payload;
+
+    auto converted_payload = cache_->get(payload, target_format_, [&]() { return convert(payload, width, height); });
+    if (converted_payload == nullptr) {
+        conversion_errors_++;
+        ec = make_error_code(connection_error::no_buffer_space);
+        return nullptr;
+    }
+
+    frames_converted_++;
+
+    return converted_payload;
+}
+
+CdiTools::Payload CdiTools::FormatConversionStage::convert(Payload payload, int width, int height)
+{
+    auto converted_payload = PayloadData::create(payload->stream_identifier(), get_frame_size(target_format_, width, height));
+    if (converted_payload == nullptr) {
+        LOG_DEBUG << "Failed to allocate a buffer to convert a frame of stream #" << payload->stream_identifier()
+            << " to " << enum_name(pixel_format_map, target_format_) << ".";
+        return nullptr;
+    }
+
+    converted_payload->metadata().copy_from(payload->metadata());
+
+    auto source_layout = ColorConversion::get_packed_layout(source_format_);
+    size_t source_stride = static_cast<size_t>(width) * source_layout.bytes_per_pixel;
+    auto target = static_cast<uint8_t*>(converted_payload->sgl_head_ptr->address_ptr);
+    auto get_source_row = [&](int y, std::vector<uint8_t>& row_buffer) {
+        // rows split across SGL entries are converted from a scratch buffer
+        const uint8_t* source = PayloadRange::get_contiguous(*payload, y * source_stride, source_stride);
+        if (source == nullptr) {
+            row_buffer.resize(source_stride);
+            PayloadRange::read(*payload, y * source_stride, row_buffer.data(), source_stride);
+            source = row_buffer.data();
+        }
+
+        return source;
+    };
+
+    // bands of rows are spread over the worker pool
+    int bands = (height + band_height - 1) / band_height;
+    if (is_packed(target_format_)) {
+        auto target_layout = ColorConversion::get_packed_layout(target_format_);
+        size_t target_stride = static_cast<size_t>(width) * target_layout.bytes_per_pixel;
+        ThreadPool::instance().parallel_for(bands, [&](int band) {
+            thread_local std::vector<uint8_t> row_buffer;
+            for (int y = band * band_height; y < std::min(height, (band + 1) * band_height); y++) {
+                ColorConversion::convert_packed_row(get_source_row(y, row_buffer), source_layout, target + y * target_stride, target_layout, width);
+            }
+        });
+    }
+    else {
+        int chroma_width = (width + 1) / 2;
+        int chroma_height = (height + 1) / 2;
+        bool is_interleaved = PixelFormat::Nv12 == target_format_;
+        uint8_t* y_plane = target;
+        uint8_t* u_plane = y_plane + static_cast<size_t>(width) * height;
+        uint8_t* v_plane = is_interleaved ? nullptr : u_plane + static_cast<size_t>(chroma_width) * chroma_height;
+        size_t chroma_stride = is_interleaved ? 2 * static_cast<size_t>(chroma_width) : chroma_width;
+        ThreadPool::instance().parallel_for(bands, [&](int band) {
+            thread_local std::vector<uint8_t> row_buffers[2];
+            for (int y = band * band_height; y < std::min(height, (band + 1) * band_height); y += 2) {
+                // an odd last row is paired with itself
+                bool has_pair = y + 1 < height;
+                const uint8_t* source_row0 = get_source_row(y, row_buffers[0]);
+                const uint8_t* source_row1 = has_pair ? get_source_row(y + 1, row_buffers[1]) : source_row0;
+                ColorConversion::convert_yuv420_rows(source_row0, source_row1, source_layout, width,
+                    y_plane + static_cast<size_t>(y) * width, has_pair ? y_plane + static_cast<size_t>(y + 1) * width : nullptr,
+                    u_plane + (y / 2) * chroma_stride, v_plane != nullptr ? v_plane + (y / 2) * chroma_stride : nullptr);
+            }
+        });
+    }
+
+    return converted_payload;
+}
+
+std::string CdiTools::FormatConversionStage::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << "frames: " << frames_converted_
+        << ", errors: " << conversion_errors_
+        << ", conversions: " << cache_->get_conversions()
+        << ", shared: " << cache_->get_shared();
+
+    return statistics.str();
+}
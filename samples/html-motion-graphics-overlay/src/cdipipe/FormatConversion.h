@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <future>
+
+#include "IStage.h"
+#include "PixelFormat.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Conversions of video frames to other pixel formats, keyed by source payload and target format. The
+    // first output that asks for a format converts the frame, outputs asking for the same format later, or
+    // while the conversion is under way, share the result. Only formats requested by an output are computed.
+    class ConversionCache
+    {
+    public:
+        ConversionCache(size_t capacity);
+
+        Payload get(Payload source, PixelFormat target_format, std::function<Payload()> convert);
+        inline int64_t get_conversions() const { return conversions_; }
+        inline int64_t get_shared() const { return shared_; }
+
+    private:
+        struct Entry
+        {
+            const PayloadData* source_ptr;
+            std::weak_ptr<PayloadData> source;
+            PixelFormat target_format;
+            std::shared_future<Payload> result;
+        };
+
+        size_t capacity_;
+        std::mutex gate_;
+        std::deque<Entry> entries_;
+        std::atomic<int64_t> conversions_;
+        std::atomic<int64_t> shared_;
+    };
+
+    // Converts the frames of a video stream to the pixel format of the output it is bound to.
+    class FormatConversionStage
+        : public IStage
+    {
+    public:
+        FormatConversionStage(std::shared_ptr<ConversionCache> cache, PixelFormat source_format, PixelFormat target_format);
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Video; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Video; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+
+    private:
+        Payload convert(Payload payload, int width, int height);
+
+        std::string name_;
+        std::shared_ptr<ConversionCache> cache_;
+        PixelFormat source_format_;
+        PixelFormat target_format_;
+        std::atomic<int64_t> frames_converted_;
+        std::atomic<int64_t> conversion_errors_;
+        Logger logger_;
+    };
+}
@@ -0,0 +1,191 @@
+#include <numeric>
+
+#include <boost/asio.hpp>
+
+#include "FrameClock.h"
+#include "Configuration.h"
+#include "Exceptions.h"
+#include "TimeSource.h"
+
+using namespace boost::asio;
+using asio_error = boost::system::error_code;
+
+static const char* logger_name = "FrameClock";
+
+CdiTools::FrameClock::FrameClock()
+    : next_subscription_{ 1 }
+    , logger_{ logger_name }
+{
+    // ticks aligned to the reference clock epoch line up across hosts that share a PTP disciplined clock
+    epoch_ = Configuration::genlock_utc ? TimeSource::instance().to_steady_time(std::chrono::nanoseconds(0)) : clock::now();
+}
+
+CdiTools::FrameClock::~FrameClock()
+{
+    shutdown();
+}
+
+CdiTools::FrameClock& CdiTools::FrameClock::instance()
+{
+    static FrameClock instance;
+
+    return instance;
+}
+
+int CdiTools::FrameClock::subscribe(int frame_rate_numerator, int frame_rate_denominator, io_context& io, TickHandler handler)
+{
+    auto frame_rate = normalize(frame_rate_numerator, frame_rate_denominator);
+
+    std::lock_guard<std::mutex> lock(gate_);
+    int subscription = next_subscription_++;
+    get_cadence(frame_rate)->subscribers[subscription] = Subscriber{ &io, handler };
+    subscriptions_[subscription] = frame_rate;
+
+    return subscription;
+}
+
+void CdiTools::FrameClock::unsubscribe(int subscription)
+{
+    std::lock_guard<std::mutex> lock(gate_);
+    auto frame_rate = subscriptions_.find(subscription);
+    if (frame_rate == subscriptions_.end()) return;
+
+    auto cadence = cadences_.find(frame_rate->second);
+    if (cadence != cadences_.end()) {
+        cadence->second->subscribers.erase(subscription);
+    }
+
+    subscriptions_.erase(frame_rate);
+}
+
+void CdiTools::FrameClock::async_wait(int frame_rate_numerator, int frame_rate_denominator, io_context& io, TickHandler handler)
+{
+    auto frame_rate = normalize(frame_rate_numerator, frame_rate_denominator);
+
+    std::lock_guard<std::mutex> lock(gate_);
+    get_cadence(frame_rate)->waiters.push_back(Subscriber{ &io, handler });
+}
+
+uint64_t CdiTools::FrameClock::get_current_tick(int frame_rate_numerator, int frame_rate_denominator) const
+{
+    return get_current_tick(normalize(frame_rate_numerator, frame_rate_denominator));
+}
+
+CdiTools::FrameClock::clock::time_point CdiTools::FrameClock::get_tick_time(int frame_rate_numerator, int frame_rate_denominator, uint64_t tick) const
+{
+    return get_tick_time(normalize(frame_rate_numerator, frame_rate_denominator), tick);
+}
+
+void CdiTools::FrameClock::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        for (auto&& cadence : cadences_) {
+            cadence.second->timer.cancel();
+        }
+
+        cadences_.clear();
+        subscriptions_.clear();
+        active_.reset();
+    }
+
+    io_.stop();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+CdiTools::FrameClock::FrameRate CdiTools::FrameClock::normalize(int frame_rate_numerator, int frame_rate_denominator)
+{
+    if (frame_rate_numerator <= 0 || frame_rate_denominator <= 0) {
+        throw InvalidConfigurationException(std::string("Invalid frame rate " + std::to_string(frame_rate_numerator)
+            + "/" + std::to_string(frame_rate_denominator) + " requested from the frame clock."));
+    }
+
+    // equivalent rates, e.g. 50/2 and 25/1, share the same cadence
+    int divisor = std::gcd(frame_rate_numerator, frame_rate_denominator);
+
+    return FrameRate{ frame_rate_numerator / divisor, frame_rate_denominator / divisor };
+}
+
+CdiTools::FrameClock::clock::time_point CdiTools::FrameClock::get_tick_time(const FrameRate& frame_rate, uint64_t tick) const
+{
+    // split into whole seconds and remainder to keep exact fractional rates (e.g. 30000/1001) from drifting or overflowing
+    uint64_t frames = tick * frame_rate.second;
+    uint64_t seconds = frames / frame_rate.first;
+    uint64_t remainder = frames % frame_rate.first;
+    std::chrono::nanoseconds offset(seconds * 1000000000ull + remainder * 1000000000ull / frame_rate.first);
+
+    return epoch_ + std::chrono::duration_cast<clock::duration>(offset);
+}
+
+uint64_t CdiTools::FrameClock::get_current_tick(const FrameRate& frame_rate) const
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch_).count();
+    if (elapsed <= 0) return 0;
+
+    uint64_t seconds = elapsed / 1000000000ull;
+    uint64_t nanoseconds = elapsed % 1000000000ull;
+
+    return (seconds * frame_rate.first + nanoseconds * frame_rate.first / 1000000000ull) / frame_rate.second;
+}
+
+std::shared_ptr<CdiTools::FrameClock::Cadence> CdiTools::FrameClock::get_cadence(const FrameRate& frame_rate)
+{
+    auto cadence = cadences_.find(frame_rate);
+    if (cadence != cadences_.end()) {
+        return cadence->second;
+    }
+
+    if (active_ == nullptr) {
+        active_ = std::make_unique<io_context::work>(io_);
+        if (!thread_.joinable()) {
+            io_.restart();
+            thread_ = std::thread([&]() { io_.run(); });
+        }
+    }
+
+    LOG_DEBUG << "Starting frame clock cadence for " << frame_rate.first << "/" << frame_rate.second << " fps.";
+    auto new_cadence = std::make_shared<Cadence>(frame_rate, io_);
+    new_cadence->next_tick = get_current_tick(frame_rate) + 1;
+    cadences_[frame_rate] = new_cadence;
+    schedule(new_cadence);
+
+    return new_cadence;
+}
+
+void CdiTools::FrameClock::schedule(std::shared_ptr<Cadence> cadence)
+{
+    cadence->timer.expires_at(get_tick_time(cadence->frame_rate, cadence->next_tick));
+    cadence->timer.async_wait(std::bind(&FrameClock::tick, this, cadence, std::placeholders::_1));
+}
+
+void CdiTools::FrameClock::tick(std::shared_ptr<Cadence> cadence, const asio_error& ec)
+{
+    if (ec) return;
+
+    std::lock_guard<std::mutex> lock(gate_);
+    if (cadences_.count(cadence->frame_rate) == 0) return;
+
+    // a cadence nobody listened to during a whole frame is dropped rather than left ticking
+    if (cadence->subscribers.empty() && cadence->waiters.empty()) {
+        LOG_DEBUG << "Stopping idle frame clock cadence for " << cadence->frame_rate.first << "/" << cadence->frame_rate.second << " fps.";
+        cadences_.erase(cadence->frame_rate);
+        return;
+    }
+
+    uint64_t tick = cadence->next_tick;
+    for (auto&& subscriber : cadence->subscribers) {
+        post(*subscriber.second.io, std::bind(subscriber.second.handler, tick));
+    }
+
+    for (auto&& waiter : cadence->waiters) {
+        post(*waiter.io, std::bind(waiter.handler, tick));
+    }
+
+    cadence->waiters.clear();
+
+    // skip the ticks missed while the process was not scheduled instead of delivering them in a burst
+    cadence->next_tick = std::max(tick + 1, get_current_tick(cadence->frame_rate) + 1);
+    schedule(cadence);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Process-wide frame clock. Generates the frame ticks for each distinct frame rate from a single
+    // timer per rate, with every rate phase-aligned to a common epoch, either the process start or
+    // the UTC (PTP) epoch. Tick handlers are posted to the io_context of each subscriber.
+    class FrameClock
+    {
+    public:
+        typedef std::chrono::steady_clock clock;
+        typedef std::function<void(uint64_t tick)> TickHandler;
+
+        ~FrameClock();
+
+        static FrameClock& instance();
+
+        // delivers every tick to the handler until the subscription is cancelled
+        int subscribe(int frame_rate_numerator, int frame_rate_denominator, boost::asio::io_context& io, TickHandler handler);
+        void unsubscribe(int subscription);
+        // delivers the next tick to the handler only
+        void async_wait(int frame_rate_numerator, int frame_rate_denominator, boost::asio::io_context& io, TickHandler handler);
+        uint64_t get_current_tick(int frame_rate_numerator, int frame_rate_denominator) const;
+        clock::time_point get_tick_time(int frame_rate_numerator, int frame_rate_denominator, uint64_t tick) const;
+        void shutdown();
+
+    private:
+        typedef std::pair<int, int> FrameRate;
+
+        struct Subscriber
+        {
+            boost::asio::io_context* io;
+            TickHandler handler;
+        };
+
+        struct Cadence
+        {
+            Cadence(const FrameRate& frame_rate, boost::asio::io_context& io) : frame_rate{ frame_rate }, timer{ io }, next_tick{ 0 } {}
+            FrameRate frame_rate;
+            boost::asio::steady_timer timer;
+            uint64_t next_tick;
+            std::map<int, Subscriber> subscribers;
+            std::vector<Subscriber> waiters;
+        };
+
+        FrameClock();
+
+        static FrameRate normalize(int frame_rate_numerator, int frame_rate_denominator);
+        clock::time_point get_tick_time(const FrameRate& frame_rate, uint64_t tick) const;
+        uint64_t get_current_tick(const FrameRate& frame_rate) const;
+        std::shared_ptr<Cadence> get_cadence(const FrameRate& frame_rate);
+        void schedule(std::shared_ptr<Cadence> cadence);
+        void tick(std::shared_ptr<Cadence> cadence, const boost::system::error_code& ec);
+
+        boost::asio::io_context io_;
+        std::unique_ptr<boost::asio::io_context::work> active_;
+        std::thread thread_;
+        std::mutex gate_;
+        clock::time_point epoch_;
+        std::map<FrameRate, std::shared_ptr<Cadence>> cadences_;
+        std::map<int, FrameRate> subscriptions_;
+        int next_subscription_;
+        Logger logger_;
+    };
+}
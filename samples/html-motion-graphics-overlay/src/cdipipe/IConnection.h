@@ -37,5 +37,6 @@ namespace CdiTools
         virtual void add_stream(std::shared_ptr<Stream> stream) = 0;
         virtual std::shared_ptr<Stream> get_stream(uint16_t stream_identifier) = 0;
         virtual PayloadBuffer& get_buffer() = 0;
+        virtual std::string get_statistics() const = 0;
     };
 }
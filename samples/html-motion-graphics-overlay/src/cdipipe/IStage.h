@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <system_error>
+
+#include "Payload.h"
+#include "PayloadType.h"
+
+namespace CdiTools
+{
+    class Stream;
+
+    // A processing stage of a channel pipeline. Ports are typed by payload type; a stage with an
+    // unspecified input type accepts any payload and one with an unspecified output type passes its
+    // input type through. Payloads are shared by every branch of a fan-out, so a stage placed after
+    // one should return a new payload instead of modifying its input in place.
+    class IStage {
+    public:
+        virtual ~IStage() {}
+
+        virtual const std::string& get_name() const = 0;
+        virtual PayloadType get_input_type() const = 0;
+        virtual PayloadType get_output_type() const = 0;
+        // returns the payload to pass downstream or nullptr to discard it
+        virtual Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) = 0;
+        virtual std::string get_statistics() const = 0;
+    };
+}
@@ -0,0 +1,310 @@
+#include <boost/asio.hpp>
+
+#include "ImpairedConnection.h"
+#include "Errors.h"
+#include "Exceptions.h"
+#include "Utils.h"
+
+using namespace boost::asio;
+using asio_error = boost::system::error_code;
+
+bool CdiTools::ImpairmentProfile::is_enabled() const
+{
+    return delay_ms > 0 || jitter_ms > 0 || loss_percent > 0 || reorder_percent > 0
+        || rate_mbps > 0 || (stall_percent > 0 && stall_ms > 0);
+}
+
+std::string CdiTools::ImpairmentProfile::to_string() const
+{
+    std::ostringstream text;
+    text << "delay: " << delay_ms << " ms"
+        << ", jitter: " << jitter_ms << " ms"
+        << ", loss: " << loss_percent << "%"
+        << ", reorder: " << reorder_percent << "%"
+        << ", rate: ";
+    if (rate_mbps > 0) {
+        text << rate_mbps << " Mbps";
+    }
+    else {
+        text << "unlimited";
+    }
+
+    text << ", stalls: " << stall_percent << "% x " << stall_ms << " ms"
+        << ", seed: " << seed;
+
+    return text.str();
+}
+
+CdiTools::ImpairmentProfile CdiTools::ImpairmentProfile::parse(const std::string& text)
+{
+    ImpairmentProfile profile;
+
+    std::vector<std::string> settings;
+    Utils::split<std::string>(text, ',', std::back_inserter(settings));
+    for (auto&& setting : settings) {
+        auto separator = setting.find('=');
+        std::string name = setting.substr(0, separator);
+        std::string value = separator != std::string::npos ? setting.substr(separator + 1) : "";
+
+        bool is_valid = !value.empty();
+        if (is_valid) {
+            std::istringstream parser(value);
+            if (name == "delay") parser >> profile.delay_ms;
+            else if (name == "jitter") parser >> profile.jitter_ms;
+            else if (name == "loss") parser >> profile.loss_percent;
+            else if (name == "reorder") parser >> profile.reorder_percent;
+            else if (name == "rate") parser >> profile.rate_mbps;
+            else if (name == "seed") parser >> profile.seed;
+            else if (name == "stall") {
+                char delimiter = 0;
+                parser >> profile.stall_percent >> delimiter >> profile.stall_ms;
+                is_valid = delimiter == ':';
+            }
+            else is_valid = false;
+
+            is_valid = is_valid && !parser.fail() && parser.eof();
+        }
+
+        if (!is_valid) {
+            throw InvalidConfigurationException(std::string("Invalid impairment setting '") + setting + "' found in '" + text + "'.");
+        }
+    }
+
+    if (profile.delay_ms < 0 || profile.jitter_ms < 0 || profile.rate_mbps < 0 || profile.stall_ms < 0
+        || profile.loss_percent < 0 || profile.loss_percent > 100
+        || profile.reorder_percent < 0 || profile.reorder_percent > 100
+        || profile.stall_percent < 0 || profile.stall_percent > 100) {
+        throw InvalidConfigurationException(std::string("Impairment settings '") + text + "' are out of range.");
+    }
+
+    return profile;
+}
+
+CdiTools::ImpairedConnection::ImpairedConnection(std::shared_ptr<IConnection> connection,
+    const ImpairmentProfile& profile, io_context& io)
+    : connection_{ connection }
+    , profile_{ profile }
+    , io_{ io }
+    , logger_{ connection->get_name() }
+    , generator_{ profile.seed }
+    , link_available_{ clock::now() }
+    , payloads_lost_{ 0 }
+    , payloads_reordered_{ 0 }
+    , link_stalls_{ 0 }
+{
+    LOG_INFO << "Connection '" << get_name() << "' is impaired - " << profile_.to_string() << ".";
+}
+
+CdiTools::ImpairedConnection::~ImpairedConnection()
+{
+    LOG_TRACE << "Impaired connection '" << get_name() << "' is being destroyed...";
+}
+
+void CdiTools::ImpairedConnection::disconnect(std::error_code& ec)
+{
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        held_payload_.reset();
+        pending_payloads_.clear();
+    }
+
+    connection_->disconnect(ec);
+    LOG_DEBUG << "Impaired connection '" << get_name() << "' closed - " << get_statistics() << ".";
+}
+
+std::string CdiTools::ImpairedConnection::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << "impairments - lost: " << payloads_lost_
+        << ", reordered: " << payloads_reordered_
+        << ", stalls: " << link_stalls_;
+
+    auto connection_statistics = connection_->get_statistics();
+    if (!connection_statistics.empty()) {
+        statistics << ", " << connection_statistics;
+    }
+
+    return statistics.str();
+}
+
+void CdiTools::ImpairedConnection::async_receive(ReceiveHandler handler)
+{
+    Payload payload;
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        if (!pending_payloads_.empty()) {
+            payload = pending_payloads_.front();
+            pending_payloads_.pop_front();
+        }
+    }
+
+    // a payload held back by an earlier reordering is released before reading the next one
+    if (payload != nullptr) {
+        post(io_, std::bind(handler, std::error_code(), payload));
+        return;
+    }
+
+    connection_->async_receive(std::bind(&ImpairedConnection::payload_received,
+        shared_from_this(), handler, std::placeholders::_1, std::placeholders::_2));
+}
+
+void CdiTools::ImpairedConnection::payload_received(ReceiveHandler handler, const std::error_code& ec, Payload payload)
+{
+    // errors are reported to the channel undisturbed
+    if (ec || payload == nullptr) {
+        handler(ec, payload);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(gate_);
+    bool is_lost = draw(profile_.loss_percent);
+    bool is_held = !is_lost && held_payload_ == nullptr && draw(profile_.reorder_percent);
+    if (is_lost || is_held) {
+        if (is_lost) {
+            ++payloads_lost_;
+        }
+        else {
+            ++payloads_reordered_;
+            held_payload_ = payload;
+        }
+
+        lock.unlock();
+
+        // the channel expects a payload for each receive request so keep reading
+        if (!has_persistent_receive()) {
+            connection_->async_receive(std::bind(&ImpairedConnection::payload_received,
+                shared_from_this(), handler, std::placeholders::_1, std::placeholders::_2));
+        }
+
+        return;
+    }
+
+    auto due_time = schedule(payload->get_size());
+    Payload held_payload = std::move(held_payload_);
+    if (held_payload != nullptr && !has_persistent_receive()) {
+        pending_payloads_.push_back(held_payload);
+        held_payload.reset();
+    }
+
+    lock.unlock();
+
+    deliver_payload(handler, payload, due_time);
+    if (held_payload != nullptr) {
+        deliver_payload(handler, held_payload, due_time + std::chrono::microseconds(1));
+    }
+}
+
+void CdiTools::ImpairedConnection::deliver_payload(ReceiveHandler handler, Payload payload, clock::time_point due_time)
+{
+    if (due_time <= clock::now()) {
+        post(io_, std::bind(handler, std::error_code(), payload));
+        return;
+    }
+
+    auto timer = std::make_shared<steady_timer>(io_, due_time);
+    timer->async_wait([timer, handler, payload](const asio_error& ec) {
+        if (!ec) {
+            handler(std::error_code(), payload);
+        }
+    });
+}
+
+void CdiTools::ImpairedConnection::async_transmit(Payload payload, TransmitHandler handler)
+{
+    if (!connection_->is_connected()) {
+        connection_->async_transmit(payload, handler);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(gate_);
+    bool is_lost = draw(profile_.loss_percent);
+    bool is_held = !is_lost && held_payload_ == nullptr && draw(profile_.reorder_percent);
+    if (is_lost || is_held) {
+        if (is_lost) {
+            ++payloads_lost_;
+        }
+        else {
+            ++payloads_reordered_;
+            held_payload_ = payload;
+        }
+
+        lock.unlock();
+
+        // a payload lost in the network looks like a successful transmission to the sender
+        post(io_, std::bind(handler, std::error_code()));
+        return;
+    }
+
+    auto due_time = schedule(payload->get_size());
+    Payload held_payload = std::move(held_payload_);
+    lock.unlock();
+
+    if (due_time <= clock::now()) {
+        transmit_payload(payload, held_payload, handler);
+        return;
+    }
+
+    auto timer = std::make_shared<steady_timer>(io_, due_time);
+    timer->async_wait([self = shared_from_this(), timer, payload, held_payload, handler](const asio_error& ec) {
+        if (ec) {
+            handler(connection_error::transmit_error);
+            return;
+        }
+
+        self->transmit_payload(payload, held_payload, handler);
+    });
+}
+
+void CdiTools::ImpairedConnection::transmit_payload(Payload payload, Payload held_payload, TransmitHandler handler)
+{
+    if (held_payload == nullptr) {
+        connection_->async_transmit(payload, handler);
+        return;
+    }
+
+    // send the payload held back by an earlier reordering once the current one has gone out
+    connection_->async_transmit(payload, [self = shared_from_this(), held_payload, handler](const std::error_code& ec) {
+        if (ec) {
+            handler(ec);
+            return;
+        }
+
+        self->connection_->async_transmit(held_payload, handler);
+    });
+}
+
+bool CdiTools::ImpairedConnection::draw(double percent)
+{
+    if (percent <= 0) return false;
+
+    std::uniform_real_distribution<double> distribution(0.0, 100.0);
+
+    return distribution(generator_) < percent;
+}
+
+CdiTools::ImpairedConnection::clock::time_point CdiTools::ImpairedConnection::schedule(size_t payload_size)
+{
+    using namespace std::chrono;
+
+    // payloads are serialized over an emulated link that may stall and has a limited bandwidth
+    auto start_time = std::max(clock::now(), link_available_);
+    if (profile_.stall_ms > 0 && draw(profile_.stall_percent)) {
+        ++link_stalls_;
+        start_time += milliseconds(profile_.stall_ms);
+    }
+
+    link_available_ = start_time;
+    if (profile_.rate_mbps > 0) {
+        link_available_ += duration_cast<clock::duration>(
+            duration<double, std::micro>(payload_size * 8 / profile_.rate_mbps));
+    }
+
+    // propagation delay with jitter, never delivered before the link has finished sending it
+    int delay_us = profile_.delay_ms * 1000;
+    if (profile_.jitter_ms > 0) {
+        std::uniform_int_distribution<int> distribution(-profile_.jitter_ms * 1000, profile_.jitter_ms * 1000);
+        delay_us = std::max(0, delay_us + distribution(generator_));
+    }
+
+    return link_available_ + microseconds(delay_us);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <random>
+#include <chrono>
+
+#include <boost/asio/io_context.hpp>
+
+#include "IConnection.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Network conditions emulated by an impaired connection. The textual form is a comma separated
+    // list of settings, e.g. "delay=20,jitter=5,loss=0.5,reorder=1,rate=500,stall=0.1:250,seed=7".
+    struct ImpairmentProfile
+    {
+        int delay_ms{ 0 };                  // fixed latency added to every payload
+        int jitter_ms{ 0 };                 // uniform variation (+/-) applied to the latency
+        double loss_percent{ 0 };           // probability of discarding a payload
+        double reorder_percent{ 0 };        // probability of holding back a payload until after the next one
+        double rate_mbps{ 0 };              // link bandwidth cap (0 = unlimited)
+        double stall_percent{ 0 };          // probability of the link stalling before a payload
+        int stall_ms{ 0 };                  // duration of each stall
+        unsigned int seed{ 1 };             // random generator seed, for reproducible runs
+
+        bool is_enabled() const;
+        std::string to_string() const;
+        static ImpairmentProfile parse(const std::string& text);
+    };
+
+    // Decorates an existing connection injecting the delay, jitter, loss, reordering, bandwidth limit
+    // and stalls described by an impairment profile into its receive and/or transmit paths.
+    class ImpairedConnection
+        : public IConnection
+        , public std::enable_shared_from_this<ImpairedConnection>
+    {
+    public:
+        ImpairedConnection(std::shared_ptr<IConnection> connection, const ImpairmentProfile& profile, boost::asio::io_context& io);
+        ~ImpairedConnection() override;
+
+        inline bool is_connected() const override { return connection_->is_connected(); }
+        inline ConnectionStatus get_status() const override { return connection_->get_status(); }
+        inline void async_connect(ConnectHandler handler) override { connection_->async_connect(handler); }
+        inline void async_accept(ConnectHandler handler) override { connection_->async_accept(handler); }
+        void disconnect(std::error_code& ec) override;
+        void async_receive(ReceiveHandler handler) override;
+        void async_transmit(Payload payload, TransmitHandler handler) override;
+        inline ConnectionType get_type() const override { return connection_->get_type(); }
+        inline const std::string& get_name() const override { return connection_->get_name(); }
+        inline ConnectionDirection get_direction() const override { return connection_->get_direction(); }
+        inline ConnectionMode get_mode() const override { return connection_->get_mode(); }
+        inline int get_payloads_received() const override { return connection_->get_payloads_received(); }
+        inline int get_payloads_transmitted() const override { return connection_->get_payloads_transmitted(); }
+        inline void add_stream(std::shared_ptr<Stream> stream) override { connection_->add_stream(stream); }
+        inline std::shared_ptr<Stream> get_stream(uint16_t stream_identifier) override { return connection_->get_stream(stream_identifier); }
+        inline PayloadBuffer& get_buffer() override { return connection_->get_buffer(); }
+        std::string get_statistics() const override;
+
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        // CDI connections keep delivering payloads to the handler installed by a single receive request
+        inline bool has_persistent_receive() const { return connection_->get_type() == ConnectionType::Cdi; }
+        void payload_received(ReceiveHandler handler, const std::error_code& ec, Payload payload);
+        void deliver_payload(ReceiveHandler handler, Payload payload, clock::time_point due_time);
+        void transmit_payload(Payload payload, Payload held_payload, TransmitHandler handler);
+        bool draw(double percent);
+        clock::time_point schedule(size_t payload_size);
+
+        std::shared_ptr<IConnection> connection_;
+        ImpairmentProfile profile_;
+        boost::asio::io_context& io_;
+        Logger logger_;
+        std::mutex gate_;
+        std::mt19937 generator_;
+        clock::time_point link_available_;
+        Payload held_payload_;
+        std::deque<Payload> pending_payloads_;
+        std::atomic_int payloads_lost_;
+        std::atomic_int payloads_reordered_;
+        std::atomic_int link_stalls_;
+    };
+}
@@ -0,0 +1,176 @@
+#include <cmath>
+#include <algorithm>
+
+#include "IoShards.h"
+
+using namespace std::chrono;
+
+namespace
+{
+    // utilization gap between the busiest and the least busy shard that triggers a move
+    const double imbalance_threshold = 0.2;
+}
+
+CdiTools::IoShards::IoShards(const std::string& name, int shard_count)
+    : logger_{ name }
+{
+    for (int i = 0; i < std::max(1, shard_count); i++) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+CdiTools::IoShards::~IoShards()
+{
+    stop();
+}
+
+void CdiTools::IoShards::start(std::function<void()> thread_initializer)
+{
+    for (auto&& shard : shards_) {
+        if (shard->thread.joinable()) continue;
+
+        shard->io.restart();
+        shard->work = std::make_unique<boost::asio::io_context::work>(shard->io);
+        shard->thread = std::thread([&io = shard->io, thread_initializer]() {
+            if (thread_initializer) {
+                thread_initializer();
+            }
+
+            io.run();
+        });
+    }
+
+    LOG_INFO << "Connection handlers run on " << shards_.size() << " io shards.";
+}
+
+void CdiTools::IoShards::stop()
+{
+    for (auto&& shard : shards_) {
+        shard->work.reset();
+        shard->io.stop();
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+}
+
+void CdiTools::IoShards::add_connection(const std::string& connection_name)
+{
+    get_assignment(connection_name);
+}
+
+std::shared_ptr<CdiTools::IoShards::Assignment> CdiTools::IoShards::get_assignment(const std::string& connection_name)
+{
+    std::lock_guard<std::mutex> lock(assignments_gate_);
+    auto& assignment = assignments_[connection_name];
+    if (assignment == nullptr) {
+        // new connections go to the shard with the fewest connections
+        std::vector<int> connection_counts(shards_.size(), 0);
+        for (auto&& entry : assignments_) {
+            if (entry.second != nullptr) {
+                connection_counts[entry.second->target_shard]++;
+            }
+        }
+
+        int shard = static_cast<int>(std::min_element(connection_counts.begin(), connection_counts.end()) - connection_counts.begin());
+        assignment = std::make_shared<Assignment>();
+        assignment->connection_name = connection_name;
+        assignment->shard = shard;
+        assignment->target_shard = shard;
+        LOG_DEBUG << "Connection '" << connection_name << "' assigned to io shard #" << shard << ".";
+    }
+
+    return assignment;
+}
+
+void CdiTools::IoShards::dispatch(std::shared_ptr<Assignment> assignment, std::function<void()> handler)
+{
+    // a pending move is only safe when no handler of the connection is queued or running
+    if (assignment->pending_handlers++ == 0) {
+        assignment->shard = assignment->target_shard.load();
+    }
+
+    auto& shard = *shards_[assignment->shard];
+    auto post_time = steady_clock::now();
+    boost::asio::post(shard.io, [&shard, assignment, handler, post_time]() {
+        auto start_time = steady_clock::now();
+        handler();
+        auto busy_time_ns = static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - start_time).count());
+
+        shard.queue_delay_ns += static_cast<uint64_t>(duration_cast<nanoseconds>(start_time - post_time).count());
+        shard.busy_time_ns += busy_time_ns;
+        shard.handlers++;
+        assignment->busy_time_ns += busy_time_ns;
+        assignment->pending_handlers--;
+    });
+}
+
+void CdiTools::IoShards::rebalance(steady_clock::duration interval)
+{
+    double interval_ns = static_cast<double>(duration_cast<nanoseconds>(interval).count());
+    if (interval_ns <= 0) return;
+
+    for (auto&& shard : shards_) {
+        uint64_t busy_time_ns = shard->busy_time_ns;
+        uint64_t queue_delay_ns = shard->queue_delay_ns;
+        uint64_t handlers = shard->handlers;
+        shard->utilization = (busy_time_ns - shard->last_busy_time_ns) / interval_ns;
+        shard->average_queue_delay_us = handlers > shard->last_handlers
+            ? (queue_delay_ns - shard->last_queue_delay_ns) / 1000.0 / (handlers - shard->last_handlers) : 0;
+        shard->last_busy_time_ns = busy_time_ns;
+        shard->last_queue_delay_ns = queue_delay_ns;
+        shard->last_handlers = handlers;
+    }
+
+    std::lock_guard<std::mutex> lock(assignments_gate_);
+    for (auto&& entry : assignments_) {
+        auto& assignment = *entry.second;
+        uint64_t busy_time_ns = assignment.busy_time_ns;
+        assignment.utilization = (busy_time_ns - assignment.last_busy_time_ns) / interval_ns;
+        assignment.last_busy_time_ns = busy_time_ns;
+    }
+
+    auto by_utilization = [](const auto& a, const auto& b) { return a->utilization < b->utilization; };
+    auto busiest = std::max_element(shards_.begin(), shards_.end(), by_utilization) - shards_.begin();
+    auto idlest = std::min_element(shards_.begin(), shards_.end(), by_utilization) - shards_.begin();
+    double imbalance = shards_[busiest]->utilization - shards_[idlest]->utilization;
+    if (imbalance < imbalance_threshold) return;
+
+    // the connection whose load is closest to half the gap evens out the two shards best, a connection
+    // carrying the whole gap or more would only move the imbalance
+    std::shared_ptr<Assignment> candidate;
+    for (auto&& entry : assignments_) {
+        auto& assignment = entry.second;
+        if (assignment->target_shard != busiest || assignment->utilization <= 0 || assignment->utilization >= imbalance) continue;
+
+        if (candidate == nullptr || std::abs(assignment->utilization - imbalance / 2) < std::abs(candidate->utilization - imbalance / 2)) {
+            candidate = assignment;
+        }
+    }
+
+    if (candidate != nullptr) {
+        LOG_INFO << "Moving connection '" << candidate->connection_name << "' (load: " << static_cast<int>(candidate->utilization * 100) << "%)"
+            << " from io shard #" << busiest << " (" << static_cast<int>(shards_[busiest]->utilization * 100) << "%)"
+            << " to io shard #" << idlest << " (" << static_cast<int>(shards_[idlest]->utilization * 100) << "%).";
+        candidate->target_shard = static_cast<int>(idlest);
+    }
+}
+
+void CdiTools::IoShards::show_status()
+{
+    for (size_t i = 0; i < shards_.size(); i++) {
+        std::string connections;
+        {
+            std::lock_guard<std::mutex> lock(assignments_gate_);
+            for (auto&& entry : assignments_) {
+                if (entry.second->shard == static_cast<int>(i)) {
+                    connections += (connections.empty() ? "" : ", ") + entry.first;
+                }
+            }
+        }
+
+        LOG_INFO << "IO shard #" << i << " - load: " << static_cast<int>(shards_[i]->utilization * 100) << "%"
+            << ", queue delay: " << static_cast<int>(shards_[i]->average_queue_delay_us) << " us"
+            << ", connections: " << connections;
+    }
+}
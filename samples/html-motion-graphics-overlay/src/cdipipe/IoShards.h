@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Set of single-threaded io contexts that run the completion handlers of channel connections. Each
+    // connection is assigned to one shard, so its handlers run in order. Shards measure how busy they are
+    // and how long handlers wait in their queue, and rebalance() moves a connection from the busiest shard
+    // to the least busy one when their load differs by more than a threshold. A move takes effect only
+    // once the connection has no handler queued or running, which keeps the order of its payloads.
+    class IoShards
+    {
+    public:
+        IoShards(const std::string& name, int shard_count);
+        ~IoShards();
+
+        void start(std::function<void()> thread_initializer);
+        void stop();
+        // assigns a connection to the least loaded shard, once
+        void add_connection(const std::string& connection_name);
+        void rebalance(std::chrono::steady_clock::duration interval);
+        void show_status();
+
+        // returns a handler that runs the given handler on the shard of the connection
+        template <typename THandler>
+        auto wrap(const std::string& connection_name, THandler handler)
+        {
+            auto assignment = get_assignment(connection_name);
+            return [this, assignment, handler](auto... arguments) {
+                dispatch(assignment, [handler, arguments...]() { handler(arguments...); });
+            };
+        }
+
+    private:
+        struct Shard
+        {
+            boost::asio::io_context io;
+            std::unique_ptr<boost::asio::io_context::work> work;
+            std::thread thread;
+            std::atomic<uint64_t> busy_time_ns{ 0 };
+            std::atomic<uint64_t> queue_delay_ns{ 0 };
+            std::atomic<uint64_t> handlers{ 0 };
+            uint64_t last_busy_time_ns{ 0 };
+            uint64_t last_queue_delay_ns{ 0 };
+            uint64_t last_handlers{ 0 };
+            // written by rebalance() and read by show_status() from another thread
+            std::atomic<double> utilization{ 0 };
+            std::atomic<double> average_queue_delay_us{ 0 };
+        };
+
+        struct Assignment
+        {
+            std::string connection_name;
+            std::atomic_int shard{ 0 };
+            std::atomic_int target_shard{ 0 };
+            std::atomic_int pending_handlers{ 0 };
+            std::atomic<uint64_t> busy_time_ns{ 0 };
+            uint64_t last_busy_time_ns{ 0 };
+            std::atomic<double> utilization{ 0 };
+        };
+
+        std::shared_ptr<Assignment> get_assignment(const std::string& connection_name);
+        void dispatch(std::shared_ptr<Assignment> assignment, std::function<void()> handler);
+
+        std::vector<std::unique_ptr<Shard>> shards_;
+        std::mutex assignments_gate_;
+        std::map<std::string, std::shared_ptr<Assignment>> assignments_;
+        Logger logger_;
+    };
+}
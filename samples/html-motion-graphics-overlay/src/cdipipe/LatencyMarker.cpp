@@ -0,0 +1,177 @@
+#include <vector>
+#include <algorithm>
+
+#include "LatencyMarker.h"
+#include "VideoStream.h"
+#include "PayloadRange.h"
+
+namespace
+{
+    const uint16_t marker_magic = 0xA55A;
+    const int marker_bits = 128;
+
+    // blocks narrower than this are blurred beyond recognition by the filters of most scalers
+    const int min_block_width = 3;
+    // the marker covers 1/40th of the frame height, but no fewer rows than this
+    const int height_fraction = 40;
+    const int min_marker_rows = 4;
+
+    struct MarkerLayout
+    {
+        size_t row_size;
+        int bytes_per_pixel;
+        int frame_width;
+        int marker_rows;
+    };
+
+    bool get_layout(const CdiTools::PayloadData& payload, CdiTools::VideoStream& stream, MarkerLayout& layout)
+    {
+        layout.bytes_per_pixel = stream.bytes_per_pixel();
+        layout.frame_width = stream.frame_width();
+        layout.row_size = static_cast<size_t>(layout.frame_width) * layout.bytes_per_pixel;
+        layout.marker_rows = CdiTools::LatencyMarker::get_marker_rows(stream);
+
+        // the marker and the row used to erase it must fit in the frame
+        return layout.frame_width >= marker_bits * min_block_width && layout.bytes_per_pixel > 0
+            && static_cast<size_t>(payload.get_size()) >= layout.row_size * (layout.marker_rows + 1);
+    }
+
+    // blocks are laid out in proportion to the frame width so that scaling keeps them aligned with
+    // the positions computed from the dimensions of the scaled frame
+    int get_block_start(const MarkerLayout& layout, int bit)
+    {
+        return static_cast<int>(static_cast<int64_t>(bit) * layout.frame_width / marker_bits);
+    }
+
+    void read_row(const CdiSgList& sgl, size_t offset, std::vector<uint8_t>& row)
+    {
+        CdiTools::PayloadRange::read(sgl, offset, row.data(), row.size());
+    }
+
+    void write_row(const CdiSgList& sgl, size_t offset, const std::vector<uint8_t>& row)
+    {
+        CdiTools::PayloadRange::write(sgl, offset, row.data(), row.size());
+    }
+
+    // CRC-16/CCITT-FALSE
+    uint16_t get_checksum(const uint8_t* data, size_t size)
+    {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < size; i++) {
+            crc ^= static_cast<uint16_t>(data[i]) << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+            }
+        }
+
+        return crc;
+    }
+
+    // marker bits, most significant first: magic (16), sequence (32), timestamp (64), checksum (16)
+    void encode(uint32_t sequence, uint64_t timestamp, uint8_t (&bits)[marker_bits / 8])
+    {
+        int index = 0;
+        auto put = [&](uint64_t value, int size) {
+            for (int i = size - 8; i >= 0; i -= 8) {
+                bits[index++] = static_cast<uint8_t>(value >> i);
+            }
+        };
+
+        put(marker_magic, 16);
+        put(sequence, 32);
+        put(timestamp, 64);
+        put(get_checksum(bits, index), 16);
+    }
+
+    std::vector<uint8_t>& get_row_buffer(size_t size)
+    {
+        thread_local std::vector<uint8_t> row;
+        row.resize(size);
+
+        return row;
+    }
+}
+
+bool CdiTools::LatencyMarker::insert(PayloadData& payload, VideoStream& stream, uint32_t sequence, std::chrono::nanoseconds timestamp)
+{
+    MarkerLayout layout;
+    if (!get_layout(payload, stream, layout)) return false;
+
+    uint8_t bits[marker_bits / 8];
+    encode(sequence, static_cast<uint64_t>(timestamp.count()), bits);
+
+    auto& row = get_row_buffer(layout.row_size);
+    std::fill(row.begin(), row.end(), 0);
+    for (int bit = 0; bit < marker_bits; bit++) {
+        if (bits[bit / 8] & (0x80 >> (bit % 8))) {
+            size_t start = static_cast<size_t>(get_block_start(layout, bit)) * layout.bytes_per_pixel;
+            size_t end = static_cast<size_t>(get_block_start(layout, bit + 1)) * layout.bytes_per_pixel;
+            std::fill(row.begin() + start, row.begin() + end, 0xFF);
+        }
+    }
+
+    for (int i = 0; i < layout.marker_rows; i++) {
+        write_row(payload, i * layout.row_size, row);
+    }
+
+    return true;
+}
+
+bool CdiTools::LatencyMarker::detect(const PayloadData& payload, VideoStream& stream, uint32_t& sequence, std::chrono::nanoseconds& timestamp)
+{
+    MarkerLayout layout;
+    if (!get_layout(payload, stream, layout)) return false;
+
+    // sample the centre of each block, away from edges blurred by scaling or chroma subsampling
+    auto& row = get_row_buffer(layout.row_size);
+    read_row(payload, (layout.marker_rows / 2) * layout.row_size, row);
+
+    uint8_t bits[marker_bits / 8] = { 0 };
+    for (int bit = 0; bit < marker_bits; bit++) {
+        int centre = (get_block_start(layout, bit) + get_block_start(layout, bit + 1)) / 2;
+        size_t pixel = static_cast<size_t>(centre) * layout.bytes_per_pixel;
+        int level = 0;
+        for (int i = 0; i < layout.bytes_per_pixel; i++) {
+            level += row[pixel + i];
+        }
+
+        if (level >= 128 * layout.bytes_per_pixel) {
+            bits[bit / 8] |= 0x80 >> (bit % 8);
+        }
+    }
+
+    uint16_t magic = static_cast<uint16_t>((bits[0] << 8) | bits[1]);
+    uint16_t checksum = static_cast<uint16_t>((bits[14] << 8) | bits[15]);
+    if (magic != marker_magic || checksum != get_checksum(bits, 14)) return false;
+
+    sequence = 0;
+    for (int i = 2; i < 6; i++) {
+        sequence = (sequence << 8) | bits[i];
+    }
+
+    uint64_t value = 0;
+    for (int i = 6; i < 14; i++) {
+        value = (value << 8) | bits[i];
+    }
+
+    timestamp = std::chrono::nanoseconds(static_cast<int64_t>(value));
+
+    return true;
+}
+
+void CdiTools::LatencyMarker::remove(PayloadData& payload, VideoStream& stream)
+{
+    MarkerLayout layout;
+    if (!get_layout(payload, stream, layout)) return;
+
+    auto& row = get_row_buffer(layout.row_size);
+    read_row(payload, layout.marker_rows * layout.row_size, row);
+    for (int i = 0; i < layout.marker_rows; i++) {
+        write_row(payload, i * layout.row_size, row);
+    }
+}
+
+int CdiTools::LatencyMarker::get_marker_rows(VideoStream& stream)
+{
+    return std::max(min_marker_rows, stream.frame_height() / height_fraction);
+}
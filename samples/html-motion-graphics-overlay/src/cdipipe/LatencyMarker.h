@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+
+#include "Payload.h"
+
+namespace CdiTools
+{
+    class VideoStream;
+
+    // Machine readable marker carrying a sequence number and a timestamp, drawn into the top pixel
+    // rows of a video frame as a strip of black and white blocks. The strip spans the frame width and
+    // a fixed fraction of its height, so it scales with the picture and survives the color conversion
+    // and scaling of external processes that do not preserve metadata, down to a quarter of the width
+    // of a 1920 pixel wide frame. The marker can be read back anywhere downstream to measure the latency
+    // from the point where it was last stamped.
+    namespace LatencyMarker
+    {
+        bool insert(PayloadData& payload, VideoStream& stream, uint32_t sequence, std::chrono::nanoseconds timestamp);
+        bool detect(const PayloadData& payload, VideoStream& stream, uint32_t& sequence, std::chrono::nanoseconds& timestamp);
+        // number of rows covered by the marker in the frames of stream
+        int get_marker_rows(VideoStream& stream);
+        // replaces the marker rows with the first row of the picture below them
+        void remove(PayloadData& payload, VideoStream& stream);
+    }
+}
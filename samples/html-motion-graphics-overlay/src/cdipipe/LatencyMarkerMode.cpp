@@ -0,0 +1,8 @@
+#include "LatencyMarkerMode.h"
+
+enum_map<CdiTools::LatencyMarkerMode> CdiTools::latency_marker_mode_map{
+    { "None", LatencyMarkerMode::None },
+    { "Insert", LatencyMarkerMode::Insert },
+    { "Measure", LatencyMarkerMode::Measure },
+    { "Remove", LatencyMarkerMode::Remove }
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Enum.h"
+
+namespace CdiTools
+{
+    enum class LatencyMarkerMode
+    {
+        None,
+        Insert,
+        Measure,
+        Remove
+    };
+
+    extern enum_map<LatencyMarkerMode> latency_marker_mode_map;
+}
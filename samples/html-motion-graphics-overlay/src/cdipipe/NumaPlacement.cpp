@@ -0,0 +1,219 @@
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+#include "NumaPlacement.h"
+#include "Configuration.h"
+
+static const char* logger_name = "NUMA";
+
+namespace
+{
+    // parses lists such as "0-3,8-11" used by sysfs for nodes and CPUs
+    bool parse_list(const std::string& text, std::vector<int>& values)
+    {
+        std::istringstream input(text);
+        for (std::string range; std::getline(input, range, ',');) {
+            int first = 0;
+            int last = 0;
+            char separator = 0;
+            std::istringstream parser(range);
+            if (!(parser >> first)) return false;
+            last = first;
+            if (parser >> separator && (separator != '-' || !(parser >> last))) return false;
+
+            for (int value = first; value <= last; value++) {
+                values.push_back(value);
+            }
+        }
+
+        return !values.empty();
+    }
+
+    std::string read_line(const std::string& path)
+    {
+        std::string line;
+        std::ifstream file(path);
+        std::getline(file, line);
+
+        return line;
+    }
+}
+
+CdiTools::NumaPlacement::NumaPlacement(int node, const std::string& adapter_ip_address)
+    : node_{ -1 }
+    , baseline_{ 0, 0, 0 }
+    , logger_{ logger_name }
+{
+    if (disabled == node) return;
+
+    int node_count = get_node_count();
+    if (node_count <= 1) {
+        LOG_DEBUG << "Single NUMA node system, thread and memory placement is not needed.";
+        return;
+    }
+
+    if (adapter_node == node) {
+        node = get_adapter_node(adapter_ip_address);
+        if (node < 0) {
+            LOG_WARNING << "Unable to determine the NUMA node of the network adapter with address " << adapter_ip_address
+                << ". Threads and memory are not bound to a NUMA node.";
+            return;
+        }
+    }
+
+    if (node >= node_count || !get_node_cpus(node, cpus_)) {
+        LOG_WARNING << "NUMA node " << node << " is not available. Threads and memory are not bound to a NUMA node.";
+        return;
+    }
+
+    node_ = node;
+    get_node_statistics(node_, baseline_);
+    LOG_INFO << "Placing threads and memory on NUMA node " << node_ << " of " << node_count
+        << " (" << cpus_.size() << " CPUs)" << (adapter_node == Configuration::numa_node ? ", local to the network adapter." : ".");
+}
+
+CdiTools::NumaPlacement& CdiTools::NumaPlacement::instance()
+{
+    static NumaPlacement instance{ Configuration::numa_node, Configuration::local_ip };
+
+    return instance;
+}
+
+bool CdiTools::NumaPlacement::bind_current_thread(std::string& description)
+{
+    if (!is_enabled()) {
+        description = "no NUMA placement";
+        return false;
+    }
+
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus_) {
+        CPU_SET(cpu, &cpu_set);
+    }
+
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        description = std::string("sched_setaffinity failed: ") + strerror(errno);
+        return false;
+    }
+
+    // pages first touched by this thread and the threads it creates come from the local node
+    unsigned long node_mask = 1UL << node_;
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &node_mask, sizeof(node_mask) * 8) != 0) {
+        description = std::string("set_mempolicy failed: ") + strerror(errno);
+        return false;
+    }
+
+    description = "node " + std::to_string(node_);
+
+    return true;
+#else
+    description = "NUMA placement is not supported on this platform";
+
+    return false;
+#endif
+}
+
+bool CdiTools::NumaPlacement::bind_memory(void* address, size_t size, std::string& description)
+{
+    if (!is_enabled() || address == nullptr || size == 0) {
+        description = "no NUMA placement";
+        return false;
+    }
+
+#ifdef __linux__
+    // mbind works on whole pages, pages already touched elsewhere are migrated
+    uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(address) & ~(page_size - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(address) + size;
+    unsigned long node_mask = 1UL << node_;
+    if (syscall(SYS_mbind, start, end - start, MPOL_PREFERRED, &node_mask, sizeof(node_mask) * 8, MPOL_MF_MOVE) != 0) {
+        description = std::string("mbind failed: ") + strerror(errno);
+        return false;
+    }
+
+    description = "node " + std::to_string(node_);
+
+    return true;
+#else
+    description = "NUMA placement is not supported on this platform";
+
+    return false;
+#endif
+}
+
+void CdiTools::NumaPlacement::show_status()
+{
+    NodeStatistics statistics;
+    if (!is_enabled() || !get_node_statistics(node_, statistics)) return;
+
+    LOG_INFO << "NUMA node " << node_
+        << " - local allocations: " << statistics.local_allocations - baseline_.local_allocations
+        << ", served by other nodes: " << statistics.remote_allocations - baseline_.remote_allocations
+        << ", made from other nodes: " << statistics.cross_node_allocations - baseline_.cross_node_allocations;
+}
+
+int CdiTools::NumaPlacement::get_node_count()
+{
+    std::vector<int> nodes;
+    return parse_list(read_line("/sys/devices/system/node/online"), nodes) ? nodes.back() + 1 : 1;
+}
+
+int CdiTools::NumaPlacement::get_adapter_node(const std::string& adapter_ip_address)
+{
+    int node = -1;
+#ifdef __linux__
+    in_addr address;
+    ifaddrs* interfaces = nullptr;
+    if (inet_pton(AF_INET, adapter_ip_address.c_str(), &address) != 1 || getifaddrs(&interfaces) != 0) return -1;
+
+    for (ifaddrs* entry = interfaces; entry != nullptr; entry = entry->ifa_next) {
+        if (entry->ifa_addr == nullptr || entry->ifa_addr->sa_family != AF_INET) continue;
+
+        if (reinterpret_cast<sockaddr_in*>(entry->ifa_addr)->sin_addr.s_addr == address.s_addr) {
+            std::istringstream(read_line(std::string("/sys/class/net/") + entry->ifa_name + "/device/numa_node")) >> node;
+            break;
+        }
+    }
+
+    freeifaddrs(interfaces);
+#endif
+
+    return node;
+}
+
+bool CdiTools::NumaPlacement::get_node_cpus(int node, std::vector<int>& cpus)
+{
+    return parse_list(read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"), cpus);
+}
+
+bool CdiTools::NumaPlacement::get_node_statistics(int node, NodeStatistics& statistics)
+{
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/numastat");
+    if (!file) return false;
+
+    statistics = NodeStatistics{ 0, 0, 0 };
+    std::string name;
+    uint64_t value;
+    while (file >> name >> value) {
+        // numa_foreign counts pages intended for this node that another node had to supply
+        if (name == "local_node") statistics.local_allocations = value;
+        else if (name == "numa_foreign") statistics.remote_allocations = value;
+        else if (name == "other_node") statistics.cross_node_allocations = value;
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Keeps the threads and memory of the process on the NUMA node of the network adapter, or on a
+    // configured node. Binding the main thread early means that channel threads, worker pool threads
+    // and the polling threads started by the CDI SDK inherit its CPU affinity, and that memory they
+    // touch first, such as queue storage, is allocated locally. The CDI transmit buffer backing the
+    // payload pools is bound explicitly since the SDK allocates it.
+    class NumaPlacement
+    {
+    public:
+        static const int adapter_node = -1;
+        static const int disabled = -2;
+
+        static NumaPlacement& instance();
+
+        inline int get_node() const { return node_; }
+        inline bool is_enabled() const { return node_ >= 0; }
+        bool bind_current_thread(std::string& description);
+        bool bind_memory(void* address, size_t size, std::string& description);
+        // allocations served by remote nodes since the placement was set up
+        void show_status();
+
+    private:
+        struct NodeStatistics
+        {
+            uint64_t local_allocations;
+            uint64_t remote_allocations;
+            uint64_t cross_node_allocations;
+        };
+
+        NumaPlacement(int node, const std::string& adapter_ip_address);
+
+        static int get_node_count();
+        static int get_adapter_node(const std::string& adapter_ip_address);
+        static bool get_node_cpus(int node, std::vector<int>& cpus);
+        static bool get_node_statistics(int node, NodeStatistics& statistics);
+
+        int node_;
+        std::vector<int> cpus_;
+        NodeStatistics baseline_;
+        Logger logger_;
+    };
+}
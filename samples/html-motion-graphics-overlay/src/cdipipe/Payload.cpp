@@ -43,11 +43,32 @@ std::shared_ptr<CdiTools::PayloadData> CdiTools::PayloadData::create(CdiSgList s
     return payload_ptr;
 }
 
+std::shared_ptr<CdiTools::PayloadData> CdiTools::PayloadData::compose(uint16_t stream_identifier,
+    const std::vector<CdiSglEntry>& entries, std::vector<std::shared_ptr<PayloadData>> sources)
+{
+    struct PayloadContainer
+    {
+        PayloadContainer(uint16_t stream_identifier, const std::vector<CdiSglEntry>& entries, std::vector<std::shared_ptr<PayloadData>> sources)
+            : entries_{ entries }
+            , sources_{ std::move(sources) }
+            , payload_{ stream_identifier, entries_ } {}
+        std::vector<CdiSglEntry> entries_;
+        std::vector<std::shared_ptr<PayloadData>> sources_;
+        PayloadData payload_;
+    };
+
+    auto payload_container = std::make_shared<PayloadContainer>(stream_identifier, entries, std::move(sources));
+    std::shared_ptr<PayloadData> payload_ptr{ std::move(payload_container), &payload_container->payload_ };
+
+    return payload_ptr;
+}
+
 CdiTools::PayloadData::PayloadData(uint16_t stream_identifier, void* buffer_ptr, size_t size)
     : CdiSgList{ 0 }
     , sgl_entry_{ 0 }
     , stream_identifier_{ stream_identifier }
     , allocated_size_{ size }
+    , is_composed_{ false }
 #ifdef TRACE_PAYLOADS
     , sequence_number_{ ++next_sequence_number_ }
 #endif
@@ -70,6 +91,7 @@ CdiTools::PayloadData::PayloadData(CdiSgList sgl, uint16_t stream_identifier)
     , stream_identifier_{ stream_identifier }
     , allocated_size_{ 0 }
     , sgl_entry_{ sgl.sgl_head_ptr->address_ptr, sgl.sgl_head_ptr->size_in_bytes }
+    , is_composed_{ false }
 #ifdef TRACE_PAYLOADS
     , sequence_number_{ ++next_sequence_number_ }
 #endif
@@ -79,6 +101,31 @@ CdiTools::PayloadData::PayloadData(CdiSgList sgl, uint16_t stream_identifier)
 #endif
 }
 
+CdiTools::PayloadData::PayloadData(uint16_t stream_identifier, std::vector<CdiSglEntry>& entries)
+    : CdiSgList{ 0 }
+    , stream_identifier_{ stream_identifier }
+    , allocated_size_{ 0 }
+    , sgl_entry_{ 0 }
+    , is_composed_{ true }
+#ifdef TRACE_PAYLOADS
+    , sequence_number_{ ++next_sequence_number_ }
+#endif
+{
+    for (size_t i = 0; i < entries.size(); i++) {
+        entries[i].next_ptr = i + 1 < entries.size() ? &entries[i + 1] : nullptr;
+        total_data_size += entries[i].size_in_bytes;
+    }
+
+    if (!entries.empty()) {
+        sgl_head_ptr = &entries.front();
+        sgl_tail_ptr = &entries.back();
+    }
+
+#ifdef TRACE_PAYLOADS
+    LOG_TRACE << "Composed payload buffer #" << sequence_number_ << " from " << entries.size() << " SG entries, stream: " << stream_identifier << ", size: " << get_size();
+#endif
+}
+
 CdiTools::PayloadData::~PayloadData()
 {
     if (allocated_size_ > 0) {
@@ -91,7 +138,7 @@ CdiTools::PayloadData::~PayloadData()
             << ".";
 #endif
     }
-    else {
+    else if (!is_composed_) {
         if (total_data_size > 0) {
             CdiCoreRxFreeBuffer(this);
         }
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <cassert>
 
 #include <cdi_core_api.h>
 
 #include "Logger.h"
 #include "PayloadType.h"
+#include "PayloadMetadata.h"
+#include "PayloadProgress.h"
 
 namespace CdiTools
 {
@@ -18,20 +21,37 @@ namespace CdiTools
         inline int stream_identifier() const { return stream_identifier_; }
         inline int get_size() const { return total_data_size; }
         inline void set_size(int size) { total_data_size = size; sgl_entry_.size_in_bytes = size; }
+        inline PayloadMetadata& metadata() { return metadata_; }
+        inline const PayloadMetadata& metadata() const { return metadata_; }
+        // origination time of the payload in nanoseconds, zero when unknown
+        inline uint64_t timestamp_ns() const { return metadata_.get(MetadataSlot::Timestamp); }
+        inline void set_timestamp_ns(uint64_t timestamp_ns) { metadata_.set(MetadataSlot::Timestamp, timestamp_ns); }
+        inline bool is_damaged() const { return metadata_.has_flag(MetadataFlags::Damaged); }
+        inline void set_damaged(bool is_damaged) { metadata_.set_flag(MetadataFlags::Damaged, is_damaged); }
+        // ranges received so far of a payload forwarded before it is complete, null for complete payloads
+        inline std::shared_ptr<PayloadProgress> progress() const { return progress_; }
+        inline void set_progress(std::shared_ptr<PayloadProgress> progress) { progress_ = progress; }
     #ifdef TRACE_PAYLOADS
         inline int sequence() const { return sequence_number_; }
     #endif
 
     static std::shared_ptr<PayloadData> create(uint16_t stream_identifier, size_t size);
     static std::shared_ptr<PayloadData> create(CdiSgList sgl, uint16_t stream_identifier);
+    // creates a payload whose SG list is made of the given entries, which point into the source
+    // payloads or into static memory; the sources are kept alive for the lifetime of the payload
+    static std::shared_ptr<PayloadData> compose(uint16_t stream_identifier, const std::vector<CdiSglEntry>& entries, std::vector<std::shared_ptr<PayloadData>> sources);
 
     private:
         PayloadData(uint16_t stream_identifier, void* buffer_ptr, size_t size);
         PayloadData(CdiSgList sgl, uint16_t stream_identifier);
+        PayloadData(uint16_t stream_identifier, std::vector<CdiSglEntry>& entries);
 
         uint16_t stream_identifier_;
         size_t allocated_size_;
         CdiSglEntry sgl_entry_;
+        bool is_composed_;
+        PayloadMetadata metadata_;
+        std::shared_ptr<PayloadProgress> progress_;
 
         static Logger logger_;
 
@@ -0,0 +1,117 @@
+#include <algorithm>
+
+#include "PayloadMetadata.h"
+
+CdiTools::PayloadMetadata::PayloadMetadata()
+    : present_{ 0 }
+    , overflow_{ nullptr }
+{
+}
+
+CdiTools::PayloadMetadata::~PayloadMetadata()
+{
+    if (overflow_ != nullptr) {
+        MetadataSlab::instance().release(overflow_);
+    }
+}
+
+bool CdiTools::PayloadMetadata::set_value(uint16_t key, uint64_t value)
+{
+    if (overflow_ == nullptr) {
+        overflow_ = MetadataSlab::instance().acquire();
+        if (overflow_ == nullptr) return false;
+    }
+
+    auto keys_end = overflow_->keys + overflow_->count;
+    auto position = std::find(overflow_->keys, keys_end, key);
+    if (position == keys_end) {
+        if (overflow_->count == MetadataOverflow::capacity) return false;
+
+        overflow_->count++;
+        *position = key;
+    }
+
+    overflow_->values[position - overflow_->keys] = value;
+
+    return true;
+}
+
+bool CdiTools::PayloadMetadata::get_value(uint16_t key, uint64_t& value) const
+{
+    if (overflow_ == nullptr) return false;
+
+    auto keys_end = overflow_->keys + overflow_->count;
+    auto position = std::find(overflow_->keys, keys_end, key);
+    if (position == keys_end) return false;
+
+    value = overflow_->values[position - overflow_->keys];
+
+    return true;
+}
+
+void CdiTools::PayloadMetadata::copy_from(const PayloadMetadata& other)
+{
+    std::copy(std::begin(other.slots_), std::end(other.slots_), slots_);
+    present_ = other.present_;
+
+    if (other.overflow_ != nullptr) {
+        for (int i = 0; i < other.overflow_->count; i++) {
+            set_value(other.overflow_->keys[i], other.overflow_->values[i]);
+        }
+    }
+}
+
+uint64_t CdiTools::PayloadMetadata::pack_user_data() const
+{
+    return (get(MetadataSlot::Timecode) << 32) | (get(MetadataSlot::Sequence) & 0xffffffff);
+}
+
+void CdiTools::PayloadMetadata::unpack_user_data(uint64_t user_data)
+{
+    // senders that do not number their payloads leave the sequence at zero, the channel numbers them then
+    if ((user_data & 0xffffffff) != 0) {
+        set(MetadataSlot::Sequence, user_data & 0xffffffff);
+    }
+
+    if ((user_data >> 32) != 0) {
+        set(MetadataSlot::Timecode, user_data >> 32);
+    }
+}
+
+CdiTools::MetadataSlab& CdiTools::MetadataSlab::instance()
+{
+    static MetadataSlab instance;
+
+    return instance;
+}
+
+CdiTools::MetadataSlab::MetadataSlab()
+    : blocks_(capacity)
+    , exhausted_count_{ 0 }
+{
+    free_blocks_.reserve(capacity);
+    for (auto&& block : blocks_) {
+        free_blocks_.push_back(&block);
+    }
+}
+
+CdiTools::MetadataOverflow* CdiTools::MetadataSlab::acquire()
+{
+    std::lock_guard<std::mutex> lock(gate_);
+    if (free_blocks_.empty()) {
+        exhausted_count_++;
+        return nullptr;
+    }
+
+    auto overflow = free_blocks_.back();
+    free_blocks_.pop_back();
+    overflow->count = 0;
+
+    return overflow;
+}
+
+void CdiTools::MetadataSlab::release(MetadataOverflow* overflow)
+{
+    std::lock_guard<std::mutex> lock(gate_);
+    free_blocks_.push_back(overflow);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace CdiTools
+{
+    // typed metadata slots carried inline by every payload
+    enum class MetadataSlot : uint8_t
+    {
+        Timestamp,      // origination time in nanoseconds
+        Sequence,       // payload sequence number in its stream
+        Timecode,       // SMPTE timecode, packed BCD, relayed in the CDI payload user data
+        Flags,          // MetadataFlags
+        CropLeft,       // region of the frame covered by the (auto-cropped) overlay, in pixels
+        CropTop,
+        CropWidth,
+        CropHeight,
+        HopLatency,     // latency measured at the last hop in microseconds
+        Count
+    };
+
+    namespace MetadataFlags
+    {
+        // the payload was received with errors and its contents are incomplete
+        const uint64_t Damaged = 1;
+    }
+
+    // keys of the values stored in the overflow area
+    namespace MetadataKeys
+    {
+        // overlay tiles skipped, copied and blended when the frame was composited
+        const uint16_t TransparentTiles = 1;
+        const uint16_t OpaqueTiles = 2;
+        const uint16_t MixedTiles = 3;
+    }
+
+    // key/value entries that do not fit the typed slots, drawn from the metadata slab
+    struct MetadataOverflow
+    {
+        static const int capacity = 8;
+
+        int count;
+        uint16_t keys[capacity];
+        uint64_t values[capacity];
+    };
+
+    // Fixed-size metadata block embedded in each payload, so that stages can attach and read values without
+    // allocating. Values that have no slot go to an overflow block taken from a preallocated slab on first use.
+    class PayloadMetadata
+    {
+    public:
+        PayloadMetadata();
+        ~PayloadMetadata();
+        PayloadMetadata(const PayloadMetadata&) = delete;
+        PayloadMetadata& operator=(const PayloadMetadata&) = delete;
+
+        inline bool has(MetadataSlot slot) const { return (present_ & get_mask(slot)) != 0; }
+        inline uint64_t get(MetadataSlot slot, uint64_t default_value = 0) const { return has(slot) ? slots_[static_cast<int>(slot)] : default_value; }
+        inline void set(MetadataSlot slot, uint64_t value) { slots_[static_cast<int>(slot)] = value; present_ |= get_mask(slot); }
+        inline void clear(MetadataSlot slot) { present_ &= ~get_mask(slot); }
+        inline bool has_flag(uint64_t flag) const { return (get(MetadataSlot::Flags) & flag) != 0; }
+        inline void set_flag(uint64_t flag, bool is_set)
+        {
+            set(MetadataSlot::Flags, is_set ? get(MetadataSlot::Flags) | flag : get(MetadataSlot::Flags) & ~flag);
+        }
+
+        // returns false when the overflow block is full or the slab is exhausted
+        bool set_value(uint16_t key, uint64_t value);
+        bool get_value(uint16_t key, uint64_t& value) const;
+        void copy_from(const PayloadMetadata& other);
+
+        // 64 bits of user data travel with each CDI payload: the sequence number and the timecode
+        uint64_t pack_user_data() const;
+        void unpack_user_data(uint64_t user_data);
+
+    private:
+        static inline uint32_t get_mask(MetadataSlot slot) { return 1u << static_cast<int>(slot); }
+
+        uint64_t slots_[static_cast<int>(MetadataSlot::Count)];
+        uint32_t present_;
+        MetadataOverflow* overflow_;
+    };
+
+    // Preallocated overflow blocks shared by all payloads.
+    class MetadataSlab
+    {
+    public:
+        static const int capacity = 1024;
+
+        static MetadataSlab& instance();
+
+        MetadataOverflow* acquire();
+        void release(MetadataOverflow* overflow);
+        inline int get_exhausted_count() const { return exhausted_count_; }
+
+    private:
+        MetadataSlab();
+
+        std::mutex gate_;
+        std::vector<MetadataOverflow> blocks_;
+        std::vector<MetadataOverflow*> free_blocks_;
+        std::atomic_int exhausted_count_;
+    };
+}
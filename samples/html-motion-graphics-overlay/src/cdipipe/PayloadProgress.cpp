@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "PayloadProgress.h"
+
+CdiTools::PayloadProgress::PayloadProgress(size_t size)
+    : size_{ size }
+    , state_{ State::Receiving }
+    , completed_size_{ 0 }
+{
+}
+
+void CdiTools::PayloadProgress::complete_range(size_t offset, size_t size)
+{
+    std::unique_lock<std::mutex> lock(gate_);
+    if (State::Receiving != state_ || size == 0) return;
+
+    // ranges are kept as [begin, end) pairs, those reaching the prefix are merged into it
+    auto range = std::make_pair(offset, std::min(offset + size, size_));
+    pending_ranges_.insert(std::upper_bound(pending_ranges_.begin(), pending_ranges_.end(), range), range);
+    auto merged = pending_ranges_.begin();
+    for (; merged != pending_ranges_.end() && merged->first <= completed_size_; ++merged) {
+        completed_size_ = std::max(completed_size_, merged->second);
+    }
+
+    pending_ranges_.erase(pending_ranges_.begin(), merged);
+    if (completed_size_ == size_) {
+        state_ = State::Complete;
+    }
+
+    notify(lock);
+}
+
+void CdiTools::PayloadProgress::abort()
+{
+    std::unique_lock<std::mutex> lock(gate_);
+    if (State::Receiving != state_) return;
+
+    state_ = State::Aborted;
+    notify(lock);
+}
+
+size_t CdiTools::PayloadProgress::get_completed_size() const
+{
+    std::lock_guard<std::mutex> lock(gate_);
+
+    return completed_size_;
+}
+
+CdiTools::PayloadProgress::State CdiTools::PayloadProgress::get_state() const
+{
+    std::lock_guard<std::mutex> lock(gate_);
+
+    return state_;
+}
+
+void CdiTools::PayloadProgress::async_wait(size_t size, ProgressHandler handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        if (State::Receiving == state_ && completed_size_ <= size) {
+            waiters_.emplace_back(size, handler);
+            return;
+        }
+    }
+
+    handler();
+}
+
+void CdiTools::PayloadProgress::notify(std::unique_lock<std::mutex>& lock)
+{
+    // handlers run outside the lock, they may wait again or query the progress
+    std::vector<ProgressHandler> ready;
+    auto waiting = std::partition(waiters_.begin(), waiters_.end(), [this](const auto& waiter) {
+        return State::Receiving == state_ && completed_size_ <= waiter.first;
+    });
+
+    for (auto waiter = waiting; waiter != waiters_.end(); ++waiter) {
+        ready.push_back(std::move(waiter->second));
+    }
+
+    waiters_.erase(waiting, waiters_.end());
+    lock.unlock();
+
+    for (auto&& handler : ready) {
+        handler();
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <functional>
+
+namespace CdiTools
+{
+    // Tracks the byte ranges of a payload filled so far while it is still being received, so that outputs
+    // can forward its leading bytes before the rest arrives. Ranges may complete in any order, waiters are
+    // interested in the contiguous prefix. A payload is settled once it is either complete or aborted.
+    class PayloadProgress
+    {
+    public:
+        enum class State { Receiving, Complete, Aborted };
+        typedef std::function<void()> ProgressHandler;
+
+        PayloadProgress(size_t size);
+
+        void complete_range(size_t offset, size_t size);
+        void abort();
+        size_t get_completed_size() const;
+        State get_state() const;
+        inline bool is_settled() const { return State::Receiving != get_state(); }
+        // invokes the handler once more than the given number of leading bytes are complete or the payload
+        // is settled, either immediately or on the thread that completes the range
+        void async_wait(size_t size, ProgressHandler handler);
+
+    private:
+        void notify(std::unique_lock<std::mutex>& lock);
+
+        size_t size_;
+        mutable std::mutex gate_;
+        State state_;
+        size_t completed_size_;
+        // ranges completed beyond the contiguous prefix, ordered by offset
+        std::vector<std::pair<size_t, size_t>> pending_ranges_;
+        std::vector<std::pair<size_t, ProgressHandler>> waiters_;
+    };
+}
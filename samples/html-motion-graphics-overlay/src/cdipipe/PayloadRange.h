@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+
+#include <cdi_core_api.h>
+
+namespace CdiTools
+{
+    // Byte ranges of a payload, which may be scattered over several SGL entries.
+    namespace PayloadRange
+    {
+        // invokes action(data, position, length) for each contiguous piece of [offset, offset + size)
+        template <typename TAction>
+        void for_each(const CdiSgList& sgl, size_t offset, size_t size, TAction action)
+        {
+            size_t position = 0;
+            for (CdiSglEntry* sgl_entry_ptr = sgl.sgl_head_ptr;
+                sgl_entry_ptr != nullptr && size > 0; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+                size_t entry_size = static_cast<size_t>(sgl_entry_ptr->size_in_bytes);
+                if (offset >= entry_size) {
+                    offset -= entry_size;
+                    continue;
+                }
+
+                size_t length = std::min(entry_size - offset, size);
+                action(static_cast<uint8_t*>(sgl_entry_ptr->address_ptr) + offset, position, length);
+                position += length;
+                size -= length;
+                offset = 0;
+            }
+        }
+
+        // returns a pointer to the range when it lies within a single SGL entry, otherwise nullptr
+        inline uint8_t* get_contiguous(const CdiSgList& sgl, size_t offset, size_t size)
+        {
+            uint8_t* data = nullptr;
+            for_each(sgl, offset, size, [&](uint8_t* piece, size_t, size_t length) {
+                data = length == size ? piece : nullptr;
+            });
+
+            return data;
+        }
+
+        inline void read(const CdiSgList& sgl, size_t offset, uint8_t* data, size_t size)
+        {
+            for_each(sgl, offset, size, [&](uint8_t* piece, size_t position, size_t length) {
+                std::copy(piece, piece + length, data + position);
+            });
+        }
+
+        inline void write(const CdiSgList& sgl, size_t offset, const uint8_t* data, size_t size)
+        {
+            for_each(sgl, offset, size, [&](uint8_t* piece, size_t position, size_t length) {
+                std::copy(data + position, data + position + length, piece);
+            });
+        }
+    }
+}
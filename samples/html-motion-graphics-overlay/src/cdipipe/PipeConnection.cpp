@@ -0,0 +1,493 @@
+#ifndef _WIN32
+
+#include <fstream>
+#include <csignal>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <boost/asio.hpp>
+
+#include "PipeConnection.h"
+#include "Errors.h"
+#include "Exceptions.h"
+#include "Stream.h"
+
+using namespace boost::asio;
+using asio_error = boost::system::error_code;
+
+namespace
+{
+    // number of payloads the kernel pipe buffer should hold so the producer is not blocked by a single read
+    const int pipe_buffer_payloads = 2;
+
+    // interval between attempts to open a FIFO for writing while it has no reader
+    const auto open_retry_interval = std::chrono::milliseconds(100);
+
+    int get_max_pipe_size()
+    {
+        int max_pipe_size = 0;
+        std::ifstream("/proc/sys/fs/pipe-max-size") >> max_pipe_size;
+
+        return max_pipe_size;
+    }
+}
+
+CdiTools::PipeConnection::PipeConnection(const std::string& name, const std::string& path, ConnectionMode connection_mode,
+    ConnectionDirection connection_direction, int buffer_size, io_context& io)
+    : Connection(name, path, 0, connection_mode, connection_direction, buffer_size, io)
+    , descriptor_{ io }
+    , open_timer_{ io }
+    , pipe_size_{ 0 }
+    , is_exhausted_{ false }
+    , use_vmsplice_{ false }
+    , consumer_process_{ -1 }
+    , bytes_written_{ 0 }
+{
+    if (ConnectionDirection::In != connection_direction) {
+        if (is_standard_stream()) {
+            throw InvalidConfigurationException(std::string("Pipe connection '" + name_ + "' cannot write to the standard output, which is used for logging."));
+        }
+
+        // a consumer going away must surface as a write error rather than terminate the process
+        signal(SIGPIPE, SIG_IGN);
+    }
+}
+
+CdiTools::PipeConnection::~PipeConnection()
+{
+    LOG_TRACE << "Pipe Connection '" << name_ << "' is being destroyed...";
+}
+
+void CdiTools::PipeConnection::async_connect(ConnectHandler handler)
+{
+    async_accept(handler);
+}
+
+void CdiTools::PipeConnection::async_accept(ConnectHandler handler)
+{
+    if (is_connected()) {
+        notify_connection_change(handler, connection_error::already_connected);
+        return;
+    }
+
+    // the standard input cannot be reopened once the producer closes it
+    if (is_standard_stream() && is_exhausted_) {
+        notify_connection_change(handler, connection_error::connection_failure);
+        return;
+    }
+
+    LOG_DEBUG << (is_command() ? "Launching consumer '" : "Waiting for the other end to open pipe '") << host_name_ << "'...";
+    set_status(ConnectionStatus::Connecting);
+
+    try_open(handler);
+}
+
+void CdiTools::PipeConnection::try_open(ConnectHandler handler)
+{
+    // FIFOs are opened without blocking, a writer retries until the FIFO has a reader
+    std::error_code ec;
+    int handle = open_pipe(ec);
+    if (std::errc::no_such_device_or_address == ec) {
+        open_timer_.expires_after(open_retry_interval);
+        open_timer_.async_wait([this, self = shared_from_this(), handler](const asio_error& ec) {
+            if (ec) {
+                notify_connection_change(handler, ec);
+                return;
+            }
+
+            try_open(handler);
+        });
+        return;
+    }
+
+    if (!ec) {
+        asio_error err;
+        descriptor_.assign(handle, err);
+        ec = err;
+    }
+
+    // a reader opens its end at once, but the pipe is only ready once a writer has written to it
+    if (!ec && ConnectionDirection::In == direction_ && !is_standard_stream()) {
+        descriptor_.async_wait(posix::stream_descriptor::wait_read, [this, self = shared_from_this(), handler](const asio_error& ec) {
+            complete_open(-1, handler, ec);
+        });
+        return;
+    }
+
+    complete_open(handle, handler, ec);
+}
+
+void CdiTools::PipeConnection::complete_open(int handle, ConnectHandler handler, std::error_code ec)
+{
+    if (ec) {
+        LOG_ERROR << "Failed to open pipe '" << host_name_ << "': " << ec.message() << ".";
+        if (descriptor_.is_open()) {
+            asio_error err;
+            descriptor_.close(err);
+        }
+        else if (handle >= 0) {
+            close(handle);
+        }
+
+        set_status(ConnectionStatus::Closed);
+    }
+    else {
+        LOG_DEBUG << "Pipe '" << host_name_ << "' was opened, buffer size: " << pipe_size_ << " bytes.";
+        set_status(ConnectionStatus::Open);
+    }
+
+    notify_connection_change(handler, ec);
+}
+
+int CdiTools::PipeConnection::open_pipe(std::error_code& ec)
+{
+    int handle = -1;
+    if (ConnectionDirection::In == direction_) {
+        handle = is_standard_stream() ? dup(STDIN_FILENO) : open(host_name_.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+    else {
+        handle = is_command() ? launch_consumer(ec) : open(host_name_.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+
+    if (handle < 0) {
+        if (!ec) {
+            ec = std::error_code(errno, std::system_category());
+        }
+
+        return handle;
+    }
+
+    set_pipe_size(handle);
+
+#ifdef __linux__
+    // pages can only be spliced into an actual pipe
+    struct stat status;
+    use_vmsplice_ = ConnectionDirection::Out == direction_ && fstat(handle, &status) == 0 && S_ISFIFO(status.st_mode);
+#endif
+
+    return handle;
+}
+
+int CdiTools::PipeConnection::launch_consumer(std::error_code& ec)
+{
+    int handles[2];
+    if (pipe2(handles, O_CLOEXEC) != 0) {
+        ec = std::error_code(errno, std::system_category());
+        return -1;
+    }
+
+    // only async-signal-safe calls are allowed in the child of a multithreaded process
+    std::string command = host_name_.substr(1);
+    long max_handle = sysconf(_SC_OPEN_MAX);
+    pid_t process = fork();
+    if (process == 0) {
+        dup2(handles[0], STDIN_FILENO);
+
+        // sockets, FIFOs and shared memory opened without O_CLOEXEC must not be inherited by the consumer
+#if defined(__linux__) && defined(SYS_close_range)
+        if (syscall(SYS_close_range, 3, ~0U, 0) != 0)
+#endif
+        {
+            for (int handle = 3; handle < max_handle; handle++) {
+                close(handle);
+            }
+        }
+
+        // ignored signals stay ignored across exec, and the consumer must die on a broken pipe of its own
+        signal(SIGPIPE, SIG_DFL);
+
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    int error = errno;
+    close(handles[0]);
+    if (process < 0) {
+        close(handles[1]);
+        ec = std::error_code(error, std::system_category());
+        return -1;
+    }
+
+    consumer_process_ = process;
+    LOG_INFO << "Launched consumer process " << process << ": " << command;
+
+    return handles[1];
+}
+
+void CdiTools::PipeConnection::set_pipe_size(int handle)
+{
+#ifdef F_SETPIPE_SZ
+    // larger pipe buffers let the producer write a whole frame without waiting for each partial read
+    int pipe_size = streams_[0]->payload_size() * pipe_buffer_payloads;
+    if (fcntl(handle, F_SETPIPE_SZ, pipe_size) < 0) {
+        int max_pipe_size = get_max_pipe_size();
+        if (max_pipe_size > 0 && max_pipe_size < pipe_size) {
+            fcntl(handle, F_SETPIPE_SZ, max_pipe_size);
+        }
+    }
+
+    pipe_size_ = fcntl(handle, F_GETPIPE_SZ);
+    if (pipe_size_ > 0 && pipe_size_ < streams_[0]->payload_size()) {
+        LOG_WARNING << "Pipe '" << host_name_ << "' buffer size (" << pipe_size_ << " bytes) is smaller than a payload ("
+            << streams_[0]->payload_size() << " bytes). Consider raising /proc/sys/fs/pipe-max-size.";
+    }
+#endif
+}
+
+void CdiTools::PipeConnection::disconnect(std::error_code& ec)
+{
+    open_timer_.cancel();
+
+    asio_error err;
+    if (descriptor_.is_open()) {
+        descriptor_.close(err);
+        if (err) {
+            ec = err;
+            LOG_DEBUG << "Pipe close failure: " << ec.message() << ", code: " << ec.value() << ".";
+        }
+        else {
+            LOG_DEBUG << "Pipe '" << host_name_ << "' was closed.";
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        spliced_payloads_.clear();
+        bytes_written_ = 0;
+    }
+
+    // closing its standard input ends the consumer, which is reaped by a thread of its own so that a consumer
+    // slow to exit holds neither the channel nor the worker threads
+    if (consumer_process_ > 0) {
+        pid_t process = consumer_process_;
+        consumer_process_ = -1;
+        std::thread([process]() {
+            int status;
+            waitpid(process, &status, 0);
+        }).detach();
+    }
+
+    set_status(ConnectionStatus::Closed);
+}
+
+void CdiTools::PipeConnection::async_receive(ReceiveHandler handler)
+{
+    if (!is_connected()) {
+        notify_payload_received(handler, connection_error::not_connected, nullptr);
+        return;
+    }
+
+    auto& default_stream = streams_[0];
+    auto payload = PayloadData::create(default_stream->id(), default_stream->payload_size());
+    if (payload == nullptr) {
+        auto payload_errors = ++payload_errors_;
+        LOG_DEBUG << "Failed to obtain a payload buffer for #" << default_stream->id() << ":" << payloads_received_ + 1
+            << ", size " << default_stream->payload_size()
+            << " from the pool, total errors : " << payload_errors << ".";
+
+        notify_payload_received(handler, connection_error::no_buffer_space, payload);
+        return;
+    }
+
+    // payloads are read straight into the pool buffer, pipe contents cannot be spliced into user memory
+    std::vector<mutable_buffer> sgl;
+    for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr;
+        sgl_entry_ptr != nullptr; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+        sgl.push_back(mutable_buffer{ sgl_entry_ptr->address_ptr, (size_t)sgl_entry_ptr->size_in_bytes });
+    }
+
+    LOG_TRACE << "Pipe waiting for payload #" << payload->stream_identifier() << ":" << payloads_received_ + 1
+#ifdef TRACE_PAYLOADS
+        << " (" << payload->sequence() << ")"
+#endif
+        << "...";
+
+    std::size_t payload_size = buffer_size(sgl);
+    async_read(descriptor_, sgl,
+        [payload_size](const asio_error& ec, std::size_t bytes_transferred) -> std::size_t {
+            return !ec && bytes_transferred < payload_size ? payload_size - bytes_transferred : 0;
+        },
+        [&, payload, handler](const asio_error& ec, std::size_t bytes_received) {
+            auto payloads_received = ++payloads_received_;
+            if (ec) {
+                auto payload_errors = ++payload_errors_;
+                LOG_DEBUG << "Pipe receive failure: " << ec.message() << ", code: " << ec.value() << ", total errors: " << payload_errors << ".";
+
+                // the writer closed its end, wait for the next one
+                if (error::eof == ec) {
+                    is_exhausted_ = is_standard_stream();
+                    std::error_code err;
+                    disconnect(err);
+                }
+            }
+            else {
+                LOG_TRACE << "Pipe received payload #" << payload->stream_identifier() << "/" << payloads_received
+#ifdef TRACE_PAYLOADS
+                    << " (" << payload->sequence() << ")"
+#endif
+                    << ", size:" << bytes_received << "...";
+            }
+
+            payload->set_size(static_cast<int>(bytes_received));
+            notify_payload_received(handler, ec, payload);
+        });
+}
+
+void CdiTools::PipeConnection::async_transmit(Payload payload, TransmitHandler handler)
+{
+    if (!is_connected()) {
+        notify_payload_transmitted(handler, connection_error::not_connected);
+        return;
+    }
+
+    LOG_TRACE << "Pipe transmitting payload #" << payload->stream_identifier() << ":" << payloads_transmitted_ + 1
+#ifdef TRACE_PAYLOADS
+        << " (" << payload->sequence() << ")"
+#endif
+        << "...";
+
+    if (use_vmsplice_) {
+        write_payload(payload, 0, handler);
+        return;
+    }
+
+    std::vector<const_buffer> sgl;
+    for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr;
+        sgl_entry_ptr != nullptr; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+        sgl.push_back(const_buffer{ sgl_entry_ptr->address_ptr, (size_t)sgl_entry_ptr->size_in_bytes });
+    }
+
+    async_write(descriptor_, sgl, [&, payload, handler](const asio_error& ec, std::size_t) {
+        transmit_complete(payload, handler, ec);
+    });
+}
+
+void CdiTools::PipeConnection::write_payload(Payload payload, size_t offset, TransmitHandler handler)
+{
+#ifdef __linux__
+    // map the payload pages into the pipe instead of copying them, resuming where a partial splice stopped
+    std::vector<iovec> iov;
+    size_t position = 0;
+    size_t payload_size = static_cast<size_t>(payload->get_size());
+    for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr;
+        sgl_entry_ptr != nullptr && position < payload_size; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+        size_t entry_size = std::min(static_cast<size_t>(sgl_entry_ptr->size_in_bytes), payload_size - position);
+        if (position + entry_size > offset) {
+            size_t skip = offset > position ? offset - position : 0;
+            iov.push_back(iovec{ static_cast<char*>(sgl_entry_ptr->address_ptr) + skip, entry_size - skip });
+        }
+
+        position += entry_size;
+    }
+
+    while (offset < payload_size) {
+        ssize_t bytes_written = vmsplice(descriptor_.native_handle(), iov.data(), iov.size(), SPLICE_F_NONBLOCK);
+        if (bytes_written < 0) {
+            if (EAGAIN == errno) {
+                descriptor_.async_wait(posix::stream_descriptor::wait_write, [&, payload, offset, handler](const asio_error& ec) {
+                    if (ec) {
+                        transmit_complete(payload, handler, ec);
+                        return;
+                    }
+
+                    write_payload(payload, offset, handler);
+                });
+                return;
+            }
+
+            transmit_complete(payload, handler, asio_error(errno, boost::system::system_category()));
+            return;
+        }
+
+        offset += bytes_written;
+        {
+            std::lock_guard<std::mutex> lock(gate_);
+            bytes_written_ += bytes_written;
+        }
+
+        while (bytes_written > 0 && !iov.empty()) {
+            size_t size = std::min(static_cast<size_t>(bytes_written), iov.front().iov_len);
+            iov.front().iov_base = static_cast<char*>(iov.front().iov_base) + size;
+            iov.front().iov_len -= size;
+            bytes_written -= size;
+            if (iov.front().iov_len == 0) {
+                iov.erase(iov.begin());
+            }
+        }
+    }
+
+    // the pipe references the payload pages, so they stay out of the pool until the consumer reads them
+    {
+        std::lock_guard<std::mutex> lock(gate_);
+        spliced_payloads_.emplace_back(payload, bytes_written_);
+    }
+
+    transmit_complete(payload, handler, asio_error());
+#endif
+}
+
+void CdiTools::PipeConnection::transmit_complete(Payload payload, TransmitHandler handler, const asio_error& ec)
+{
+    auto payloads_transmitted = ++payloads_transmitted_;
+    if (ec) {
+        auto payload_errors = ++payload_errors_;
+        LOG_DEBUG << "Pipe transmit failure: " << ec.message() << ", code: " << ec.value() << ", total errors: " << payload_errors << ".";
+
+        // the consumer closed its end, wait for the next one
+        if (error::broken_pipe == ec) {
+            std::error_code err;
+            disconnect(err);
+        }
+    }
+    else {
+        LOG_TRACE << "Pipe transmitted payload #" << payload->stream_identifier() << ":" << payloads_transmitted
+#ifdef TRACE_PAYLOADS
+            << " (" << payload->sequence() << ")"
+#endif
+            << "...";
+    }
+
+    release_payloads();
+    notify_payload_transmitted(handler, ec);
+}
+
+void CdiTools::PipeConnection::release_payloads()
+{
+    if (!use_vmsplice_ || !descriptor_.is_open()) return;
+
+    // bytes still queued in the pipe tell how far the consumer has read
+    int unread = 0;
+    if (ioctl(descriptor_.native_handle(), FIONREAD, &unread) != 0) return;
+
+    std::lock_guard<std::mutex> lock(gate_);
+    uint64_t bytes_consumed = bytes_written_ - unread;
+    while (!spliced_payloads_.empty() && spliced_payloads_.front().second <= bytes_consumed) {
+        spliced_payloads_.pop_front();
+    }
+}
+
+void CdiTools::PipeConnection::add_stream(std::shared_ptr<Stream> stream)
+{
+    if (streams_.size() > 0) {
+        throw InvalidConfigurationException(
+            std::string("Pipe connection '" + name_ + "' has already been assigned to stream [" + std::to_string(streams_[0]->id()) + "]. Pipe connections support a single stream only."));
+    }
+
+    Connection::add_stream(stream);
+}
+
+std::string CdiTools::PipeConnection::get_statistics() const
+{
+    return "pipe buffer: " + std::to_string(pipe_size_) + " bytes" + (use_vmsplice_ ? ", vmsplice" : "");
+}
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <mutex>
+#include <deque>
+
+#include <sys/types.h>
+
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "Connection.h"
+
+namespace CdiTools
+{
+    // Reads fixed size payloads from the standard input ("-") or a named FIFO, e.g. raw frames written
+    // by a producer process to its standard output, directly into payload pool buffers. As an output,
+    // writes payloads to a named FIFO or, when the path starts with '|', to the standard input of a
+    // consumer process launched with the rest of the path as its command line.
+    class PipeConnection
+        : public Connection
+    {
+    public:
+        PipeConnection(const std::string& name, const std::string& path, ConnectionMode connection_mode,
+            ConnectionDirection connection_direction, int buffer_size, boost::asio::io_context& io);
+        ~PipeConnection() override;
+
+        void async_connect(ConnectHandler handler) override;
+        void async_accept(ConnectHandler handler) override;
+        void disconnect(std::error_code& ec) override;
+        void async_receive(ReceiveHandler handler) override;
+        void async_transmit(Payload payload, TransmitHandler handler) override;
+        inline ConnectionType get_type() const override { return ConnectionType::Pipe; }
+        void add_stream(std::shared_ptr<Stream> stream) override;
+        std::string get_statistics() const override;
+
+    private:
+        inline bool is_standard_stream() const { return host_name_ == "-"; }
+        inline bool is_command() const { return !host_name_.empty() && host_name_[0] == '|'; }
+        void try_open(ConnectHandler handler);
+        void complete_open(int handle, ConnectHandler handler, std::error_code ec);
+        int open_pipe(std::error_code& ec);
+        int launch_consumer(std::error_code& ec);
+        void set_pipe_size(int handle);
+        void write_payload(Payload payload, size_t offset, TransmitHandler handler);
+        void transmit_complete(Payload payload, TransmitHandler handler, const boost::system::error_code& ec);
+        void release_payloads();
+
+        boost::asio::posix::stream_descriptor descriptor_;
+        boost::asio::steady_timer open_timer_;
+        std::atomic_int pipe_size_;
+        bool is_exhausted_;
+        bool use_vmsplice_;
+        pid_t consumer_process_;
+        std::mutex gate_;
+        uint64_t bytes_written_;
+        // payloads whose pages were spliced into the pipe and must not return to the pool until consumed
+        std::deque<std::pair<Payload, uint64_t>> spliced_payloads_;
+    };
+}
+
+#endif
@@ -0,0 +1,298 @@
+#include <chrono>
+#include <deque>
+#include <sstream>
+
+#include <boost/asio/post.hpp>
+
+#include "Pipeline.h"
+#include "Exceptions.h"
+#include "ThreadPool.h"
+#include "Configuration.h"
+#include "Enum.h"
+
+using namespace std::chrono;
+
+CdiTools::Pipeline::Pipeline(const std::string& name)
+    : logger_{ name }
+{
+}
+
+void CdiTools::Pipeline::add_source(const std::string& name, PayloadType payload_type)
+{
+    add_node(name, NodeKind::Source, payload_type, payload_type);
+}
+
+void CdiTools::Pipeline::add_stage(const std::string& name, std::shared_ptr<IStage> stage, bool offload, bool lossy)
+{
+    auto& node = *nodes_[add_node(name, NodeKind::Stage, stage->get_input_type(), stage->get_output_type())];
+    node.stage = stage;
+    node.is_lossy = lossy;
+    if (offload) {
+        if (Configuration::offload_queue_size < 1) {
+            throw InvalidConfigurationException(std::string("The queue of offloaded stage '") + name + "' must hold at least one payload.");
+        }
+
+        // a strand keeps payloads in order even though the stage runs on any of the pool threads
+        node.strand = std::make_unique<Strand>(ThreadPool::instance().get_executor());
+    }
+}
+
+void CdiTools::Pipeline::add_sink(const std::string& name, PayloadType payload_type, std::shared_ptr<IConnection> connection, SinkHandler handler)
+{
+    auto& node = *nodes_[add_node(name, NodeKind::Sink, payload_type, payload_type)];
+    node.connection = connection;
+    node.handler = handler;
+}
+
+size_t CdiTools::Pipeline::add_node(const std::string& name, NodeKind kind, PayloadType input_type, PayloadType output_type)
+{
+    if (has_node(name)) {
+        throw InvalidConfigurationException(std::string("Pipeline node '") + name + "' is already defined.");
+    }
+
+    auto node = std::make_unique<Node>();
+    node->name = name;
+    node->kind = kind;
+    node->input_type = input_type;
+    node->output_type = output_type;
+    nodes_.push_back(std::move(node));
+    node_indices_.insert({ name, nodes_.size() - 1 });
+
+    return nodes_.size() - 1;
+}
+
+void CdiTools::Pipeline::connect(const std::string& from, const std::string& to)
+{
+    auto edge = std::make_unique<Edge>();
+    edge->from = get_node_index(from);
+    edge->to = get_node_index(to);
+    edge->payload_type = PayloadType::Unspecified;
+
+    if (NodeKind::Sink == nodes_[edge->from]->kind) {
+        throw InvalidConfigurationException(std::string("Pipeline sink '") + from + "' cannot have outputs.");
+    }
+
+    if (NodeKind::Source == nodes_[edge->to]->kind) {
+        throw InvalidConfigurationException(std::string("Pipeline source '") + to + "' cannot have inputs.");
+    }
+
+    nodes_[edge->from]->edges.push_back(edges_.size());
+    edges_.push_back(std::move(edge));
+}
+
+void CdiTools::Pipeline::validate()
+{
+    // topological sort, which also resolves the payload type carried by each edge
+    std::vector<int> pending_inputs(nodes_.size(), 0);
+    for (auto&& edge : edges_) {
+        pending_inputs[edge->to]++;
+    }
+
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < nodes_.size(); i++) {
+        if (pending_inputs[i] == 0) {
+            if (NodeKind::Source != nodes_[i]->kind) {
+                throw InvalidConfigurationException(std::string("Pipeline node '") + nodes_[i]->name + "' has no inputs.");
+            }
+
+            ready.push_back(i);
+        }
+    }
+
+    std::vector<PayloadType> resolved_types(nodes_.size(), PayloadType::Unspecified);
+    size_t visited = 0;
+    for (; !ready.empty(); ready.pop_front(), visited++) {
+        auto& node = *nodes_[ready.front()];
+        PayloadType input_type = NodeKind::Source == node.kind ? node.input_type : resolved_types[ready.front()];
+        PayloadType output_type = PayloadType::Unspecified == node.output_type ? input_type : node.output_type;
+
+        for (auto edge_index : node.edges) {
+            auto& edge = *edges_[edge_index];
+            auto& target = *nodes_[edge.to];
+            if (PayloadType::Unspecified != target.input_type && target.input_type != output_type) {
+                throw InvalidConfigurationException(std::string("Pipeline node '") + target.name + "' expects "
+                    + enum_name(payload_type_map, target.input_type) + " payloads but '" + node.name + "' produces "
+                    + enum_name(payload_type_map, output_type) + " payloads.");
+            }
+
+            if (PayloadType::Unspecified != resolved_types[edge.to] && resolved_types[edge.to] != output_type) {
+                throw InvalidConfigurationException(std::string("Pipeline node '") + target.name + "' receives payloads of different types.");
+            }
+
+            edge.payload_type = output_type;
+            resolved_types[edge.to] = output_type;
+            if (--pending_inputs[edge.to] == 0) {
+                ready.push_back(edge.to);
+            }
+        }
+    }
+
+    if (visited != nodes_.size()) {
+        throw InvalidConfigurationException(std::string("Pipeline contains a cycle."));
+    }
+}
+
+void CdiTools::Pipeline::clear()
+{
+    edges_.clear();
+    nodes_.clear();
+    node_indices_.clear();
+}
+
+bool CdiTools::Pipeline::has_node(const std::string& name) const
+{
+    return node_indices_.find(name) != node_indices_.end();
+}
+
+size_t CdiTools::Pipeline::get_node_index(const std::string& name) const
+{
+    auto node = node_indices_.find(name);
+    if (node == node_indices_.end()) {
+        throw InvalidConfigurationException(std::string("An unrecognized pipeline node '") + name + "' was specified.");
+    }
+
+    return node->second;
+}
+
+void CdiTools::Pipeline::push(const std::string& source, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence)
+{
+    run(get_node_index(source), payload, stream, sequence);
+}
+
+void CdiTools::Pipeline::run(size_t node_index, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence)
+{
+    auto& node = *nodes_[node_index];
+    auto start_time = steady_clock::now();
+    node.payloads++;
+
+    switch (node.kind) {
+    case NodeKind::Source:
+        forward(node, payload, stream, sequence);
+        return;
+
+    case NodeKind::Sink:
+        node.handler(payload, stream);
+        break;
+
+    case NodeKind::Stage: {
+        std::error_code ec;
+        payload = node.stage->process(payload, stream, sequence, ec);
+        if (ec) {
+            stream->payload_error();
+        }
+
+        if (payload == nullptr) {
+            node.payloads_dropped++;
+            LOG_TRACE << "Payload #" << stream->id() << ":" << sequence << " discarded by '" << node.name << "'.";
+            break;
+        }
+
+        // time spent downstream is accounted to the downstream nodes
+        node.processing_time_ns += duration_cast<nanoseconds>(steady_clock::now() - start_time).count();
+        forward(node, payload, stream, sequence);
+        return;
+    }
+    }
+
+    node.processing_time_ns += duration_cast<nanoseconds>(steady_clock::now() - start_time).count();
+}
+
+void CdiTools::Pipeline::forward(Node& node, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence)
+{
+    auto emitted_time = steady_clock::now();
+    for (auto edge_index : node.edges) {
+        traverse(*edges_[edge_index], payload, stream, sequence, emitted_time);
+    }
+}
+
+void CdiTools::Pipeline::traverse(Edge& edge, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence,
+    steady_clock::time_point emitted_time)
+{
+    auto& target = *nodes_[edge.to];
+    auto run_target = [this, &edge, payload, stream, sequence, emitted_time]() {
+        edge.payloads++;
+        edge.transit_time_ns += duration_cast<nanoseconds>(steady_clock::now() - emitted_time).count();
+        run(edge.to, payload, stream, sequence);
+    };
+
+    if (target.strand != nullptr) {
+        // a stage that cannot keep up drops payloads instead of queuing them without bound
+        if (target.payloads_queued++ >= Configuration::offload_queue_size) {
+            target.payloads_queued--;
+            target.payloads_overflowed++;
+            LOG_TRACE << "Payload #" << stream->id() << ":" << sequence << " discarded, the queue of '" << target.name << "' is full.";
+            return;
+        }
+
+        boost::asio::post(*target.strand, [&target, run_target]() {
+            run_target();
+            target.payloads_queued--;
+        });
+    }
+    else {
+        run_target();
+    }
+}
+
+bool CdiTools::Pipeline::is_congested(const std::string& source)
+{
+    std::vector<size_t> pending{ get_node_index(source) };
+    std::vector<bool> visited(nodes_.size(), false);
+    while (!pending.empty()) {
+        auto& node = *nodes_[pending.back()];
+        pending.pop_back();
+        if (NodeKind::Sink == node.kind && ConnectionStatus::Open == node.connection->get_status()
+            && node.connection->get_buffer().is_full()) {
+            return true;
+        }
+
+        if (is_saturated(node)) {
+            return true;
+        }
+
+        for (auto edge_index : node.edges) {
+            auto to = edges_[edge_index]->to;
+            if (!visited[to]) {
+                visited[to] = true;
+                pending.push_back(to);
+            }
+        }
+    }
+
+    return false;
+}
+
+bool CdiTools::Pipeline::is_saturated(const Node& node) const
+{
+    return node.strand != nullptr && !node.is_lossy && node.payloads_queued >= Configuration::offload_queue_size;
+}
+
+void CdiTools::Pipeline::show_configuration()
+{
+    for (auto&& edge : edges_) {
+        LOG_DEBUG << "Pipeline edge: " << nodes_[edge->from]->name << " --> " << nodes_[edge->to]->name
+            << " (" << enum_name(payload_type_map, edge->payload_type) << ")"
+            << (nodes_[edge->to]->strand != nullptr ? ", offloaded" : "")
+            << (nodes_[edge->to]->is_lossy ? ", lossy" : "");
+    }
+}
+
+void CdiTools::Pipeline::show_status()
+{
+    for (auto&& node : nodes_) {
+        if (NodeKind::Stage != node->kind) continue;
+
+        uint64_t payloads = node->payloads;
+        LOG_INFO << "Stage '" << node->name << "' - payloads: " << payloads
+            << ", dropped: " << node->payloads_dropped
+            << (node->strand != nullptr ? ", overflowed: " + std::to_string(node->payloads_overflowed) : "")
+            << ", average time: " << (payloads > 0 ? node->processing_time_ns / payloads / 1000 : 0) << " us"
+            << ", " << node->stage->get_statistics();
+    }
+
+    for (auto&& edge : edges_) {
+        uint64_t payloads = edge->payloads;
+        LOG_DEBUG << "Edge '" << nodes_[edge->from]->name << "' -> '" << nodes_[edge->to]->name << "' - payloads: " << payloads
+            << ", average transit: " << (payloads > 0 ? edge->transit_time_ns / payloads : 0) << " ns";
+    }
+}
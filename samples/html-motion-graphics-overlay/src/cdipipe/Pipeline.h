@@ -0,0 +1,90 @@
+#pragma once
+
+#include <map>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "IStage.h"
+#include "IConnection.h"
+#include "Stream.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Directed acyclic graph of sources, processing stages and sinks with typed ports. Payloads pushed
+    // into a source flow along every edge, stages run inline on the calling thread or, when offloaded,
+    // in order on the worker pool, each with a bounded queue. A source is congested while any sink
+    // reachable from it has a full transmit buffer or any offloaded stage reachable from it has a full
+    // queue, which lets the channel hold back its input. Lossy stages only drop payloads when their queue
+    // is full and never hold back the source. The graph must not change once payloads start flowing.
+    class Pipeline
+    {
+    public:
+        typedef std::function<void(Payload payload, std::shared_ptr<Stream> stream)> SinkHandler;
+
+        Pipeline(const std::string& name);
+
+        void add_source(const std::string& name, PayloadType payload_type);
+        void add_stage(const std::string& name, std::shared_ptr<IStage> stage, bool offload = false, bool lossy = false);
+        void add_sink(const std::string& name, PayloadType payload_type, std::shared_ptr<IConnection> connection, SinkHandler handler);
+        void connect(const std::string& from, const std::string& to);
+        void validate();
+        void clear();
+        bool has_node(const std::string& name) const;
+        void push(const std::string& source, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence);
+        bool is_congested(const std::string& source);
+        void show_configuration();
+        void show_status();
+
+    private:
+        enum class NodeKind { Source, Stage, Sink };
+        typedef boost::asio::strand<boost::asio::thread_pool::executor_type> Strand;
+
+        struct Node
+        {
+            std::string name;
+            NodeKind kind;
+            PayloadType input_type;
+            PayloadType output_type;
+            std::shared_ptr<IStage> stage;
+            std::unique_ptr<Strand> strand;
+            bool is_lossy{ false };
+            std::shared_ptr<IConnection> connection;
+            SinkHandler handler;
+            std::vector<size_t> edges;
+            std::atomic<uint64_t> payloads{ 0 };
+            std::atomic<uint64_t> payloads_dropped{ 0 };
+            std::atomic<uint64_t> payloads_overflowed{ 0 };
+            // payloads posted to the strand of an offloaded stage and not yet processed
+            std::atomic_int payloads_queued{ 0 };
+            std::atomic<uint64_t> processing_time_ns{ 0 };
+        };
+
+        struct Edge
+        {
+            size_t from;
+            size_t to;
+            PayloadType payload_type;
+            std::atomic<uint64_t> payloads{ 0 };
+            std::atomic<uint64_t> transit_time_ns{ 0 };
+        };
+
+        size_t add_node(const std::string& name, NodeKind kind, PayloadType input_type, PayloadType output_type);
+        size_t get_node_index(const std::string& name) const;
+        bool is_saturated(const Node& node) const;
+        void run(size_t node_index, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence);
+        void forward(Node& node, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence);
+        void traverse(Edge& edge, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence,
+            std::chrono::steady_clock::time_point emitted_time);
+
+        std::vector<std::unique_ptr<Node>> nodes_;
+        std::vector<std::unique_ptr<Edge>> edges_;
+        std::map<std::string, size_t> node_indices_;
+        Logger logger_;
+    };
+}
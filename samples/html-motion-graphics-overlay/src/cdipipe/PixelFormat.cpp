@@ -0,0 +1,26 @@
+#include "PixelFormat.h"
+
+enum_map<CdiTools::PixelFormat> CdiTools::pixel_format_map{
+    { "Rgb24", PixelFormat::Rgb24 },
+    { "Bgr24", PixelFormat::Bgr24 },
+    { "Rgba", PixelFormat::Rgba },
+    { "Bgra", PixelFormat::Bgra },
+    { "Yuv420p", PixelFormat::Yuv420p },
+    { "Nv12", PixelFormat::Nv12 }
+};
+
+int CdiTools::get_frame_size(PixelFormat pixel_format, int width, int height)
+{
+    switch (pixel_format) {
+    case PixelFormat::Rgba:
+    case PixelFormat::Bgra: return width * height * 4;
+    case PixelFormat::Yuv420p:
+    case PixelFormat::Nv12: return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+    default: return width * height * 3;
+    }
+}
+
+bool CdiTools::is_packed(PixelFormat pixel_format)
+{
+    return PixelFormat::Yuv420p != pixel_format && PixelFormat::Nv12 != pixel_format;
+}
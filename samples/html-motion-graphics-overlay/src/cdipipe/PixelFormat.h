@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Enum.h"
+
+namespace CdiTools
+{
+    // pixel layouts of raw video frames, named after their FFmpeg equivalents
+    enum class PixelFormat
+    {
+        Rgb24,
+        Bgr24,
+        Rgba,
+        Bgra,
+        Yuv420p,    // planar Y, U and V, chroma subsampled 2x2
+        Nv12        // planar Y followed by interleaved UV, chroma subsampled 2x2
+    };
+
+    extern enum_map<PixelFormat> pixel_format_map;
+
+    int get_frame_size(PixelFormat pixel_format, int width, int height);
+    bool is_packed(PixelFormat pixel_format);
+}
@@ -0,0 +1,283 @@
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "PluginStage.h"
+#include "VideoStream.h"
+#include "Errors.h"
+#include "Exceptions.h"
+#include "ThreadPool.h"
+#include "TimeSource.h"
+
+namespace
+{
+    CdiPipePayloadType map_payload_type(CdiTools::PayloadType payload_type)
+    {
+        switch (payload_type) {
+        case CdiTools::PayloadType::Audio: return kCdiPipePayloadAudio;
+        case CdiTools::PayloadType::Ancillary: return kCdiPipePayloadAncillary;
+        default: return kCdiPipePayloadVideo;
+        }
+    }
+
+    // reason for the last failure to load a library or find a symbol in it
+    std::string get_load_error()
+    {
+#ifdef _WIN32
+        char message[512] = { 0 };
+        DWORD error = GetLastError();
+        DWORD length = FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, nullptr, error, 0, message, sizeof(message), nullptr);
+        while (length > 0 && (message[length - 1] == '\r' || message[length - 1] == '\n' || message[length - 1] == '.')) {
+            message[--length] = '\0';
+        }
+
+        return length > 0 ? std::string(message) : "error " + std::to_string(error);
+#else
+        const char* message = dlerror();
+        return message != nullptr ? std::string(message) : "unknown error";
+#endif
+    }
+}
+
+CdiTools::PluginStage::PluginStage(const std::string& specification)
+    : library_{ nullptr }
+    , stage_{ nullptr }
+    , instance_{ nullptr }
+    , host_{}
+    , logger_{ "Plugin" }
+    , payloads_processed_{ 0 }
+    , payloads_dropped_{ 0 }
+    , payloads_replaced_{ 0 }
+    , payload_errors_{ 0 }
+    , processing_time_us_{ 0 }
+{
+    auto separator = specification.find('?');
+    path_ = specification.substr(0, separator);
+    arguments_ = separator != std::string::npos ? specification.substr(separator + 1) : "";
+    name_ = path_;
+
+#ifdef _WIN32
+    library_ = LoadLibraryA(path_.c_str());
+#else
+    library_ = dlopen(path_.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+    if (library_ == nullptr) {
+        throw InvalidConfigurationException(std::string("Failed to load plugin '" + path_ + "': " + get_load_error() + "."));
+    }
+
+    auto get_stage = reinterpret_cast<CdiPipeGetStage>(load_symbol(CDIPIPE_PLUGIN_ENTRY));
+    if (get_stage == nullptr) {
+        std::string error = get_load_error();
+        unload();
+        throw InvalidConfigurationException(std::string("Plugin '" + path_ + "' does not export a '" CDIPIPE_PLUGIN_ENTRY "' entry point: " + error + "."));
+    }
+
+    stage_ = get_stage();
+    if (stage_ == nullptr || stage_->create == nullptr || stage_->process == nullptr || stage_->destroy == nullptr) {
+        unload();
+        throw InvalidConfigurationException(std::string("Plugin '" + path_ + "' does not export a valid '" CDIPIPE_PLUGIN_ENTRY "' entry point."));
+    }
+
+    // plugins built for an earlier version are supported, fields added since are not read from them
+    if (stage_->api_version < 1 || stage_->api_version > CDIPIPE_PLUGIN_API_VERSION) {
+        auto api_version = stage_->api_version;
+        unload();
+        throw InvalidConfigurationException(std::string("Plugin '" + path_ + "' was built for API version " + std::to_string(api_version)
+            + ", supported versions are 1 to " + std::to_string(CDIPIPE_PLUGIN_API_VERSION) + "."));
+    }
+
+    if (stage_->name != nullptr) {
+        name_ = stage_->name;
+    }
+
+    host_.api_version = CDIPIPE_PLUGIN_API_VERSION;
+    host_.context = this;
+    host_.allocate_frame = &PluginStage::allocate_frame;
+    host_.parallel_for = &PluginStage::parallel_for;
+    host_.log = &PluginStage::log;
+
+    instance_ = stage_->create(&host_, arguments_.c_str());
+    if (instance_ == nullptr) {
+        unload();
+        throw InvalidConfigurationException(std::string("Plugin '" + name_ + "' failed to initialize with arguments '" + arguments_ + "'."));
+    }
+
+    LOG_INFO << "Loaded plugin stage '" << name_ << "' from '" << path_ << "'"
+        << (arguments_.empty() ? "" : ", arguments: " + arguments_) << ".";
+}
+
+CdiTools::PluginStage::~PluginStage()
+{
+    unload();
+}
+
+void* CdiTools::PluginStage::load_symbol(const char* symbol_name)
+{
+#ifdef _WIN32
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library_), symbol_name));
+#else
+    return dlsym(library_, symbol_name);
+#endif
+}
+
+void CdiTools::PluginStage::unload()
+{
+    if (instance_ != nullptr) {
+        stage_->destroy(instance_);
+        instance_ = nullptr;
+    }
+
+    if (library_ != nullptr) {
+#ifdef _WIN32
+        FreeLibrary(static_cast<HMODULE>(library_));
+#else
+        dlclose(library_);
+#endif
+        library_ = nullptr;
+    }
+}
+
+CdiTools::Payload CdiTools::PluginStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    Frame input;
+    describe(input, payload, stream, sequence, TimeSource::instance().now().count());
+
+    std::lock_guard<std::mutex> lock(gate_);
+    auto start_time = std::chrono::steady_clock::now();
+    CdiPipeFrame* output = nullptr;
+    CdiPipeResult result = stage_->process(instance_, &input.frame, &output);
+    processing_time_us_ += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+    ++payloads_processed_;
+
+    Payload result_payload;
+    switch (result) {
+    case kCdiPipeForward:
+        result_payload = payload;
+        break;
+    case kCdiPipeDrop:
+        ++payloads_dropped_;
+        break;
+    case kCdiPipeReplace:
+        for (auto&& frame : allocated_frames_) {
+            if (&frame->frame == output) {
+                result_payload = frame->payload;
+                result_payload->set_size(static_cast<int>(std::min(output->size, static_cast<uint32_t>(frame->buffers[0].size))));
+            }
+        }
+
+        if (result_payload != nullptr) {
+            ++payloads_replaced_;
+            break;
+        }
+
+        LOG_ERROR << "Plugin '" << name_ << "' returned a frame that was not allocated by the host.";
+        // fallthrough
+    default:
+        ++payload_errors_;
+        ec = make_error_code(connection_error::receive_error);
+        break;
+    }
+
+    // frames allocated by the plugin and not returned go back to the pool here
+    allocated_frames_.clear();
+
+    return result_payload;
+}
+
+size_t CdiTools::PluginStage::get_frame_size(uint32_t api_version)
+{
+    // frames built by a plugin only have the fields of the version it was built for, each version that
+    // extends CdiPipeFrame adds a case returning the size of the frame before the extension
+    switch (api_version) {
+    default: return sizeof(CdiPipeFrame);
+    }
+}
+
+void CdiTools::PluginStage::describe(Frame& frame, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, int64_t timestamp_ns)
+{
+    for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr;
+        sgl_entry_ptr != nullptr; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+        frame.buffers.push_back(CdiPipeBuffer{ static_cast<uint8_t*>(sgl_entry_ptr->address_ptr), static_cast<uint32_t>(sgl_entry_ptr->size_in_bytes) });
+    }
+
+    frame.stream = stream;
+    frame.payload = payload;
+    frame.frame = CdiPipeFrame{};
+    frame.frame.stream_identifier = stream->id();
+    frame.frame.type = map_payload_type(stream->get_type());
+    frame.frame.sequence = sequence;
+    frame.frame.timestamp_ns = timestamp_ns;
+    frame.frame.size = static_cast<uint32_t>(payload->get_size());
+    frame.frame.buffer_count = static_cast<uint32_t>(frame.buffers.size());
+    frame.frame.buffers = frame.buffers.data();
+
+    auto video_stream = std::dynamic_pointer_cast<VideoStream>(stream);
+    if (video_stream != nullptr) {
+        frame.frame.width = video_stream->frame_width();
+        frame.frame.height = video_stream->frame_height();
+        frame.frame.bytes_per_pixel = video_stream->bytes_per_pixel();
+        frame.frame.frame_rate_numerator = video_stream->frame_rate_numerator();
+        frame.frame.frame_rate_denominator = video_stream->frame_rate_denominator();
+    }
+}
+
+CdiPipeFrame* CdiTools::PluginStage::allocate_frame(void* context, const CdiPipeFrame* like, uint32_t size)
+{
+    // only called from within process, which holds the stage lock
+    auto stage = static_cast<PluginStage*>(context);
+    if (like == nullptr) return nullptr;
+
+    auto payload = PayloadData::create(like->stream_identifier, size);
+    if (payload == nullptr) return nullptr;
+
+    payload->set_size(static_cast<int>(size));
+
+    auto frame = std::make_unique<Frame>();
+    frame->frame = CdiPipeFrame{};
+    std::memcpy(&frame->frame, like, get_frame_size(stage->stage_->api_version));
+    frame->payload = payload;
+    frame->buffers.push_back(CdiPipeBuffer{ static_cast<uint8_t*>(payload->sgl_head_ptr->address_ptr), size });
+    frame->frame.size = size;
+    frame->frame.buffer_count = 1;
+    frame->frame.buffers = frame->buffers.data();
+    stage->allocated_frames_.push_back(std::move(frame));
+
+    return &stage->allocated_frames_.back()->frame;
+}
+
+void CdiTools::PluginStage::parallel_for(void* context, int32_t count, CdiPipeTask task, void* argument)
+{
+    if (task == nullptr) return;
+
+    ThreadPool::instance().parallel_for(count, [task, argument](int index) { task(argument, index); });
+}
+
+void CdiTools::PluginStage::log(void* context, CdiPipeLogLevel level, const char* message)
+{
+    auto stage = static_cast<PluginStage*>(context);
+    auto& logger_ = stage->logger_;
+    switch (level) {
+    case kCdiPipeLogTrace: LOG_TRACE << stage->name_ << ": " << message; break;
+    case kCdiPipeLogDebug: LOG_DEBUG << stage->name_ << ": " << message; break;
+    case kCdiPipeLogWarning: LOG_WARNING << stage->name_ << ": " << message; break;
+    case kCdiPipeLogError: LOG_ERROR << stage->name_ << ": " << message; break;
+    default: LOG_INFO << stage->name_ << ": " << message; break;
+    }
+}
+
+std::string CdiTools::PluginStage::get_statistics() const
+{
+    int payloads_processed = payloads_processed_;
+    return "processed: " + std::to_string(payloads_processed)
+        + ", dropped: " + std::to_string(payloads_dropped_)
+        + ", replaced: " + std::to_string(payloads_replaced_)
+        + ", errors: " + std::to_string(payload_errors_)
+        + ", average time: " + std::to_string(payloads_processed > 0 ? processing_time_us_ / payloads_processed : 0) + " us";
+}
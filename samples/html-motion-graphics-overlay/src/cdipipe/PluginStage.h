@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+
+#include "CdiPipePlugin.h"
+#include "IStage.h"
+#include "Payload.h"
+#include "Stream.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Processing stage implemented by a dynamically loaded plugin (see CdiPipePlugin.h). The plugin is
+    // specified as "path[?arguments]" and receives zero-copy access to each payload, pool allocation
+    // for replacement payloads and a parallel_for over the worker pool. Calls into a plugin instance
+    // are serialized, so plugins do not need to be thread safe.
+    class PluginStage
+        : public IStage
+    {
+    public:
+        PluginStage(const std::string& specification);
+        ~PluginStage();
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Unspecified; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Unspecified; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+
+    private:
+        struct Frame
+        {
+            CdiPipeFrame frame;
+            std::vector<CdiPipeBuffer> buffers;
+            std::shared_ptr<Stream> stream;
+            Payload payload;
+        };
+
+        static size_t get_frame_size(uint32_t api_version);
+        static void describe(Frame& frame, Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, int64_t timestamp_ns);
+        static CdiPipeFrame* allocate_frame(void* context, const CdiPipeFrame* like, uint32_t size);
+        static void parallel_for(void* context, int32_t count, CdiPipeTask task, void* argument);
+        static void log(void* context, CdiPipeLogLevel level, const char* message);
+        void* load_symbol(const char* symbol_name);
+        void unload();
+
+        std::string path_;
+        std::string arguments_;
+        std::string name_;
+        void* library_;
+        const CdiPipeStage* stage_;
+        void* instance_;
+        CdiPipeHost host_;
+        std::mutex gate_;
+        std::vector<std::unique_ptr<Frame>> allocated_frames_;
+        Logger logger_;
+        std::atomic_int payloads_processed_;
+        std::atomic_int payloads_dropped_;
+        std::atomic_int payloads_replaced_;
+        std::atomic_int payload_errors_;
+        std::atomic<int64_t> processing_time_us_;
+    };
+}
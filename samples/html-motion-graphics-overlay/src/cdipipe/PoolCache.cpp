@@ -0,0 +1,197 @@
+#include <algorithm>
+
+#include "PoolCache.h"
+#include "Exceptions.h"
+
+std::atomic_int CdiTools::PoolCache::next_slot_{ 0 };
+std::atomic<CdiTools::PoolCache*> CdiTools::PoolCache::live_caches_[max_caches];
+thread_local CdiTools::PoolCache::ThreadMagazines CdiTools::PoolCache::thread_magazines_[max_caches];
+
+CdiTools::PoolCache::PoolCache(CdiPoolHandle pool_handle, int magazine_size)
+    : pool_handle_{ pool_handle }
+    , magazine_size_{ magazine_size }
+    , slot_{ next_slot_++ }
+    , depot_count_{ 0 }
+{
+    if (slot_ >= max_caches) {
+        throw InvalidConfigurationException(std::string("Too many buffer pool caches were created."));
+    }
+
+    live_caches_[slot_] = this;
+}
+
+CdiTools::PoolCache::~PoolCache()
+{
+    live_caches_[slot_] = nullptr;
+    flush();
+}
+
+CdiTools::PoolCache::ThreadMagazines::~ThreadMagazines()
+{
+    // buffers cached by a thread that exits go back to the depot for other threads to use
+    if (owner != nullptr && std::find(std::begin(live_caches_), std::end(live_caches_), owner) != std::end(live_caches_)) {
+        owner->unregister(this);
+        owner->release(loaded);
+        owner->release(previous);
+    }
+}
+
+CdiTools::PoolCache::ThreadMagazines& CdiTools::PoolCache::get_thread_magazines()
+{
+    auto& magazines = thread_magazines_[slot_];
+    if (magazines.owner != this) {
+        magazines.owner = this;
+        magazines.loaded.items.reserve(magazine_size_);
+        magazines.previous.items.reserve(magazine_size_);
+
+        std::lock_guard<std::mutex> lock(registry_gate_);
+        thread_registry_.push_back(&magazines);
+    }
+
+    return magazines;
+}
+
+void CdiTools::PoolCache::unregister(ThreadMagazines* magazines)
+{
+    std::lock_guard<std::mutex> lock(registry_gate_);
+    thread_registry_.erase(std::remove(thread_registry_.begin(), thread_registry_.end(), magazines), thread_registry_.end());
+}
+
+void* CdiTools::PoolCache::get()
+{
+    if (pool_handle_ == nullptr) return nullptr;
+
+    void* buffer_ptr = nullptr;
+    if (magazine_size_ <= 0) {
+        return CdiPoolGet(pool_handle_, &buffer_ptr) ? buffer_ptr : nullptr;
+    }
+
+    auto& magazines = get_thread_magazines();
+    if (magazines.loaded.items.empty()) {
+        if (!magazines.previous.items.empty()) {
+            std::swap(magazines.loaded, magazines.previous);
+        }
+        else if (!exchange_full(magazines.loaded)) {
+            return nullptr;
+        }
+    }
+
+    // most recently released buffer first, its contents are more likely to still be in cache
+    buffer_ptr = magazines.loaded.items.back();
+    magazines.loaded.items.pop_back();
+
+    return buffer_ptr;
+}
+
+void CdiTools::PoolCache::put(void* buffer_ptr)
+{
+    if (pool_handle_ == nullptr || buffer_ptr == nullptr) return;
+
+    if (magazine_size_ <= 0) {
+        CdiPoolPut(pool_handle_, buffer_ptr);
+        return;
+    }
+
+    auto& magazines = get_thread_magazines();
+    if (static_cast<int>(magazines.loaded.items.size()) >= magazine_size_) {
+        if (magazines.previous.items.empty()) {
+            std::swap(magazines.loaded, magazines.previous);
+        }
+        else {
+            exchange_empty(magazines.loaded);
+        }
+    }
+
+    magazines.loaded.items.push_back(buffer_ptr);
+}
+
+int CdiTools::PoolCache::get_free_count() const
+{
+    if (pool_handle_ == nullptr) return 0;
+
+    // buffers in the magazines of other threads are out of reach until those threads release them
+    int count = CdiPoolGetFreeItemCount(pool_handle_) + depot_count_;
+    if (magazine_size_ > 0 && thread_magazines_[slot_].owner == this) {
+        auto& magazines = thread_magazines_[slot_];
+        count += static_cast<int>(magazines.loaded.items.size() + magazines.previous.items.size());
+    }
+
+    return count;
+}
+
+void CdiTools::PoolCache::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(registry_gate_);
+        for (auto magazines : thread_registry_) {
+            release(magazines->loaded);
+            release(magazines->previous);
+            magazines->owner = nullptr;
+        }
+
+        thread_registry_.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(depot_gate_);
+    for (auto&& magazine : full_magazines_) {
+        for (auto&& buffer_ptr : magazine.items) {
+            CdiPoolPut(pool_handle_, buffer_ptr);
+        }
+
+        depot_count_ -= static_cast<int>(magazine.items.size());
+    }
+
+    full_magazines_.clear();
+}
+
+bool CdiTools::PoolCache::exchange_full(Magazine& magazine)
+{
+    std::lock_guard<std::mutex> lock(depot_gate_);
+    if (!full_magazines_.empty()) {
+        empty_magazines_.push_back(std::move(magazine));
+        magazine = std::move(full_magazines_.back());
+        full_magazines_.pop_back();
+        depot_count_ -= static_cast<int>(magazine.items.size());
+
+        return true;
+    }
+
+    // the depot is empty, refill a whole magazine from the pool at once
+    magazine.items.clear();
+    void* buffer_ptr = nullptr;
+    while (static_cast<int>(magazine.items.size()) < magazine_size_ && CdiPoolGet(pool_handle_, &buffer_ptr)) {
+        magazine.items.push_back(buffer_ptr);
+    }
+
+    return !magazine.items.empty();
+}
+
+void CdiTools::PoolCache::exchange_empty(Magazine& magazine)
+{
+    std::lock_guard<std::mutex> lock(depot_gate_);
+    depot_count_ += static_cast<int>(magazine.items.size());
+    full_magazines_.push_back(std::move(magazine));
+    if (!empty_magazines_.empty()) {
+        magazine = std::move(empty_magazines_.back());
+        empty_magazines_.pop_back();
+    }
+    else {
+        magazine = Magazine();
+        magazine.items.reserve(magazine_size_);
+    }
+
+    magazine.items.clear();
+}
+
+void CdiTools::PoolCache::release(Magazine& magazine)
+{
+    if (magazine.items.empty()) return;
+
+    // partially filled magazines are flushed to the pool so that the depot only holds full ones
+    std::lock_guard<std::mutex> lock(depot_gate_);
+    for (auto&& buffer_ptr : magazine.items) {
+        CdiPoolPut(pool_handle_, buffer_ptr);
+    }
+
+    magazine.items.clear();
+}
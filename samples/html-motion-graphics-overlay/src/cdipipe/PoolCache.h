@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+
+#include <cdi_pool_api.h>
+
+namespace CdiTools
+{
+    // Per-thread magazine cache layered over a CDI buffer pool. Each thread keeps a loaded and a
+    // previous magazine of buffers that it reuses in LIFO order without any locking; full and empty
+    // magazines are exchanged with a shared depot, and the depot refills from and flushes to the CDI
+    // pool in batches, so the pool lock is taken once per magazine rather than once per buffer.
+    class PoolCache
+    {
+    public:
+        PoolCache(CdiPoolHandle pool_handle, int magazine_size);
+        ~PoolCache();
+
+        void* get();
+        void put(void* buffer_ptr);
+        // buffers the calling thread can obtain: those available in the pool and the depot plus its own magazines
+        int get_free_count() const;
+        inline CdiPoolHandle get_pool_handle() const { return pool_handle_; }
+        // returns the magazines of every thread and the depot contents to the pool, no other thread may use
+        // the cache while it is flushed
+        void flush();
+
+        // maximum number of caches a thread can hold magazines for
+        static const int max_caches = 4;
+
+    private:
+        struct Magazine
+        {
+            std::vector<void*> items;
+        };
+
+        struct ThreadMagazines
+        {
+            ~ThreadMagazines();
+
+            PoolCache* owner{ nullptr };
+            Magazine loaded;
+            Magazine previous;
+        };
+
+        ThreadMagazines& get_thread_magazines();
+        void unregister(ThreadMagazines* magazines);
+        bool exchange_full(Magazine& magazine);
+        void exchange_empty(Magazine& magazine);
+        void release(Magazine& magazine);
+
+        CdiPoolHandle pool_handle_;
+        int magazine_size_;
+        int slot_;
+        std::mutex depot_gate_;
+        std::vector<Magazine> full_magazines_;
+        std::vector<Magazine> empty_magazines_;
+        std::atomic_int depot_count_;
+        std::mutex registry_gate_;
+        // magazines of the threads that used the cache, so that it can take them back at shutdown
+        std::vector<ThreadMagazines*> thread_registry_;
+
+        static std::atomic_int next_slot_;
+        static std::atomic<PoolCache*> live_caches_[max_caches];
+        static thread_local ThreadMagazines thread_magazines_[max_caches];
+    };
+}
@@ -28,25 +28,65 @@ int main(int argc, char* argv[])
         .add_option("log_level",               "Set the log level", Configuration::log_level, log_level_map)
         .add_option("log_file",                "Log file name", Configuration::log_file)
         .add_option("num_threads",             "Number of channel threads", Configuration::num_threads)
+        .add_option("io_shards",               "Number of io shards that run connection handlers, rebalanced by load (0: disabled)", Configuration::io_shards)
         .add_option("inline_handlers",         "Use inline handlers", Configuration::inline_handlers)
+        .add_option("genlock",                 "Emit output payloads on the ticks of the process frame clock", Configuration::genlock)
+        .add_option("genlock_utc",             "Align frame clock ticks to the reference time source epoch instead of the process start", Configuration::genlock_utc)
+        .add_option("time_source",             "Reference clock for timestamps and frame clock alignment", Configuration::time_source, time_source_type_map)
+        .add_option("ptp_device",              "PTP hardware clock device used by the Ptp time source", Configuration::ptp_device)
+        .add_option("latency_marker",          "Insert, measure or remove the latency markers drawn in received video frames", Configuration::latency_marker, latency_marker_mode_map)
+        .add_option("standby_group",           "Name shared by a primary and its warm-standby processes, which take over when the primary fails", Configuration::standby_group)
+        .add_option("standby_timeout",         "Time without a heartbeat after which a standby takes over, in milliseconds", Configuration::standby_timeout)
+        .add_option("sched_policy",            "Scheduling policy of the channel threads", Configuration::scheduling_policy, scheduling_policy_map)
+        .add_option("sched_priority",          "Real-time priority of the channel threads (Fifo and RoundRobin policies)", Configuration::scheduling_priority)
+        .add_option("timer_slack",             "Timer slack of the channel threads in nanoseconds (0 = system default)", Configuration::timer_slack_ns)
+        .add_option("lock_memory",             "Lock process memory to prevent paging", Configuration::lock_memory)
+        .add_option("numa_node",               "NUMA node for threads and payload memory (-1 = node of the network adapter, -2 = no placement)", Configuration::numa_node)
+        .add_option("tcp_stripes",             "Number of parallel sockets used by TCP channels", Configuration::tcp_stripes)
+        .add_option("tcp_autotune",            "Size TCP socket buffers and transfers from the stream geometry", Configuration::tcp_autotune)
+        .add_option("cut_through",             "Forward video frames between TCP connections as their bytes arrive instead of once complete", Configuration::cut_through)
         .add_option("buffer_delay",            "Incoming payload buffer delay (max: " + std::to_string(MAXIMUM_RX_BUFFER_DELAY_MS) + " ms.)", Configuration::buffer_delay)
         .add_option("video_in_port",           "Video input port number", Configuration::video_in_port)
         .add_option("video_out_port",          "Video output port number", Configuration::video_out_port)
         .add_option("audio_in_port",           "Audio input port number", Configuration::audio_in_port)
         .add_option("audio_out_port",          "Audio output port number", Configuration::audio_out_port)
+        .add_option("video_in_pipe",           "Read video input from a named pipe ('-' for standard input) instead of a port", Configuration::video_in_pipe)
+        .add_option("video_out_pipe",          "Write video output to a named pipe, or to the standard input of a command prefixed with '|'", Configuration::video_out_pipe)
+        .add_option("audio_out_pipe",          "Write audio output to a named pipe, or to the standard input of a command prefixed with '|'", Configuration::audio_out_pipe)
+        .add_option("audio_in_pipe",           "Read audio input from a named pipe ('-' for standard input) instead of a port", Configuration::audio_in_pipe)
         .add_option("frame_width",             "Input source frame width", Configuration::frame_width)
         .add_option("frame_height",            "Input source frame height", Configuration::frame_height)
         .add_option("frame_rate",              "Input source frame rate", frame_rate)
+        .add_option("pixel_format",            "Pixel format of the input video frames, packed formats only", Configuration::pixel_format, pixel_format_map)
+        .add_option("video_out_format",        "Pixel format of the frames delivered by the receiver's video output (default: same as input)", Configuration::video_out_format)
+        .add_option("video_outputs",           "Additional receiver video outputs as format:port pairs separated by ';' (e.g. Yuv420p:3010;Bgra:3020)", Configuration::video_outputs)
+        .add_option("video_renditions",        "Scaled receiver video outputs as size:port pairs separated by ';', each one a stream of its own (e.g. 1280x720:3030;640x360:3040)", Configuration::video_renditions)
+        .add_option("rendition_stream_id",     "Stream identifier of the first video rendition, further renditions take the following identifiers", Configuration::rendition_stream_id)
+        .add_option("scaling_filter",          "Resampling filter used to scale video renditions", Configuration::scaling_filter, scaling_filter_map)
+        .add_option("video_concealment",       "Repeat or patch video frames received with errors from the previous frame", Configuration::video_concealment)
         .add_option("audio_sampling_rate",     "Audio sampling rate", Configuration::audio_sampling_rate, audio_sampling_rate_map)
         .add_option("audio_channel_grouping",  "Audio channel grouping", Configuration::audio_channel_grouping, audio_channel_grouping_map)
+        .add_option("audio_concealment",       "Fill gaps in received PCM audio with silence and drop late payloads", Configuration::audio_concealment)
         .add_option("tx_timeout",              "Payload transmission timeout in microseconds", Configuration::tx_timeout)
+        .add_option("cdi_bandwidth",           "Bandwidth limit of each CDI connection in Mbps, used to plan connections for the CdiAuto channel", Configuration::cdi_connection_bandwidth)
+        .add_option("impair_rx",               "Impairments applied to received payloads (e.g. delay=20,jitter=5,loss=0.5,reorder=1,rate=500,stall=0.1:250,seed=1)", Configuration::rx_impairment)
+        .add_option("impair_tx",               "Impairments applied to transmitted payloads (same settings as impair_rx)", Configuration::tx_impairment)
+        .add_option("plugins",                 "Processing stage plugins applied in order to received payloads (e.g. ./libblur.so?radius=4;./libstamp.so)", Configuration::plugins)
+        .add_option("offload_queue_size",      "Payloads queued for a stage offloaded to the worker pool before further payloads are dropped", Configuration::offload_queue_size)
+        .add_option("overlay_in_pipe",         "Read RGBA overlay frames from a named pipe, or '-' for standard input, and composite them onto the video", Configuration::overlay_in_pipe)
+        .add_option("overlay_width",           "Overlay frame width (0 = video frame width)", Configuration::overlay_width)
+        .add_option("overlay_height",          "Overlay frame height (0 = video frame height)", Configuration::overlay_height)
+        .add_option("overlay_left",            "Horizontal position of the overlay in the video frame", Configuration::overlay_left)
+        .add_option("overlay_top",             "Vertical position of the overlay in the video frame", Configuration::overlay_top)
+        .add_option("overlay_autocrop",        "Keep only the bounding box of the visible overlay pixels", Configuration::overlay_autocrop)
 #ifdef ENABLE_CLOUDWATCH
         .add_option("cloudwatch_domain",       "Dimension associated with each metric", Configuration::cloudwatch_domain)
         .add_option("cloudwatch_namespace",    "CloudWatch namespace used to hold metrics generated by CDI", Configuration::cloudwatch_namespace)
         .add_option("cloudwatch_region",       "EC2 region where the CloudWatch container is located", Configuration::cloudwatch_region)
 #endif
         .add_option("large_pool_items",        "Large payload pool maximum items", Configuration::large_buffer_pool_max_items)
-        .add_option("small_pool_items",        "Small payload pool maximum items", Configuration::small_buffer_pool_max_items);
+        .add_option("small_pool_items",        "Small payload pool maximum items", Configuration::small_buffer_pool_max_items)
+        .add_option("pool_magazine",           "Payload buffers cached per thread and pool (-1 = auto, 0 = disabled)", Configuration::pool_magazine_size);
 
     if (command_line.parse(argc, argv)) {
         if (ChannelRole::None == channel_role) {
@@ -70,6 +110,14 @@ int main(int argc, char* argv[])
             Configuration::frame_rate_denominator = tokens.size() > 1 ? tokens[1] : 1;
         }
 
+        // planar formats are produced by the receiver's video outputs, the input and the pipeline expect packed pixels
+        if (!is_packed(Configuration::pixel_format)) {
+            std::cout << "ERROR: '-pixel_format' must be a packed format (Rgb24, Bgr24, Rgba or Bgra). Use -help to see available options.\n";
+            return 1;
+        }
+
+        Configuration::bytes_per_pixel = get_frame_size(Configuration::pixel_format, 1, 1);
+
         command_line.show_version();
         std::cout << "Press 'q' to exit...\n\n";
 
@@ -0,0 +1,276 @@
+#include <cmath>
+#include <sstream>
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define USE_AVX2
+#define AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define USE_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#include "Scaler.h"
+#include "ColorConversion.h"
+#include "PayloadRange.h"
+#include "ThreadPool.h"
+#include "Exceptions.h"
+
+namespace
+{
+    // output rows scaled by each task of a parallel scaling, source rows shared by two bands are filtered twice
+    const int band_height = 16;
+
+    // horizontally filtered rows keep extra bits of precision for the vertical pass
+    const int intermediate_bits = 6;
+    const int horizontal_shift = CdiTools::FilterTable::weight_bits - intermediate_bits;
+    const int vertical_shift = CdiTools::FilterTable::weight_bits + intermediate_bits;
+
+    const double pi = 3.14159265358979323846;
+
+    double get_support(CdiTools::ScalingFilter filter)
+    {
+        switch (filter) {
+        case CdiTools::ScalingFilter::Bilinear: return 1.0;
+        case CdiTools::ScalingFilter::Bicubic: return 2.0;
+        default: return 3.0;
+        }
+    }
+
+    double evaluate(CdiTools::ScalingFilter filter, double x)
+    {
+        x = std::abs(x);
+        switch (filter) {
+        case CdiTools::ScalingFilter::Bilinear:
+            return x < 1.0 ? 1.0 - x : 0.0;
+
+        case CdiTools::ScalingFilter::Bicubic: {
+            // Keys cubic convolution with a = -0.5, as used by the FFmpeg bicubic scaler
+            const double a = -0.5;
+            if (x < 1.0) return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+            if (x < 2.0) return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+            return 0.0;
+        }
+
+        default:
+            // three lobe Lanczos window
+            if (x < 1e-8) return 1.0;
+            if (x >= 3.0) return 0.0;
+            return 3.0 * std::sin(pi * x) * std::sin(pi * x / 3.0) / (pi * pi * x * x);
+        }
+    }
+
+    void filter_horizontal(const uint8_t* source, const CdiTools::FilterTable& table, int width, int bytes_per_pixel, int16_t* target)
+    {
+        int taps = table.taps();
+        for (int x = 0; x < width; x++) {
+            const uint8_t* pixels = source + static_cast<size_t>(table.start(x)) * bytes_per_pixel;
+            const int16_t* weights = table.weights(x);
+            for (int component = 0; component < bytes_per_pixel; component++) {
+                int sum = 0;
+                for (int k = 0; k < taps; k++) {
+                    sum += weights[k] * pixels[k * bytes_per_pixel + component];
+                }
+
+                *target++ = static_cast<int16_t>((sum + (1 << (horizontal_shift - 1))) >> horizontal_shift);
+            }
+        }
+    }
+
+    void filter_vertical(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* target, int start, int length)
+    {
+        for (int i = start; i < length; i++) {
+            int sum = 0;
+            for (int k = 0; k < taps; k++) {
+                sum += weights[k] * rows[k][i];
+            }
+
+            target[i] = static_cast<uint8_t>(std::min(255, std::max(0, (sum + (1 << (vertical_shift - 1))) >> vertical_shift)));
+        }
+    }
+
+#ifdef USE_AVX2
+    // returns the number of samples filtered, the rest is left to the scalar code
+    AVX2_TARGET int filter_vertical_avx2(const int16_t* const* rows, const int16_t* weights, int taps, uint8_t* target, int length)
+    {
+        const __m256i rounding = _mm256_set1_epi32(1 << (vertical_shift - 1));
+        int i = 0;
+        for (; i + 16 <= length; i += 16) {
+            __m256i low = rounding;
+            __m256i high = rounding;
+            // rows are taken in pairs, interleaved samples are multiplied by a pair of weights and summed in 32 bits
+            for (int k = 0; k < taps; k += 2) {
+                __m256i row0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+                __m256i row1 = k + 1 < taps ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i)) : _mm256_setzero_si256();
+                int16_t weight1 = k + 1 < taps ? weights[k + 1] : 0;
+                __m256i weight_pair = _mm256_set1_epi32(static_cast<uint16_t>(weights[k]) | (static_cast<uint32_t>(static_cast<uint16_t>(weight1)) << 16));
+                low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(row0, row1), weight_pair));
+                high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(row0, row1), weight_pair));
+            }
+
+            // unpacking and packing both work within 128-bit lanes, the permutation puts the samples back in order
+            __m256i samples = _mm256_packs_epi32(_mm256_srai_epi32(low, vertical_shift), _mm256_srai_epi32(high, vertical_shift));
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(samples, samples), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm256_castsi256_si128(packed));
+        }
+
+        return i;
+    }
+#endif
+}
+
+CdiTools::FilterTable::FilterTable(int source_size, int target_size, ScalingFilter filter)
+{
+    double scale = static_cast<double>(source_size) / target_size;
+    double stretch = std::max(1.0, scale);
+    double support = get_support(filter) * stretch;
+    taps_ = std::min(source_size, 2 * static_cast<int>(std::ceil(support)));
+    starts_.resize(target_size);
+    weights_.resize(static_cast<size_t>(target_size) * taps_);
+
+    std::vector<double> weights(taps_);
+    for (int position = 0; position < target_size; position++) {
+        // sample centers are aligned, as in FFmpeg and most scalers
+        double center = (position + 0.5) * scale - 0.5;
+        int first = static_cast<int>(std::floor(center - support)) + 1;
+        int last = static_cast<int>(std::floor(center + support));
+        int start = std::max(0, std::min(first, source_size - taps_));
+
+        // samples beyond the edges repeat the edge sample, their weights are folded into it
+        std::fill(weights.begin(), weights.end(), 0.0);
+        double sum = 0.0;
+        for (int i = first; i <= last; i++) {
+            double weight = evaluate(filter, (i - center) / stretch);
+            weights[std::max(0, std::min(i, source_size - 1)) - start] += weight;
+            sum += weight;
+        }
+
+        // rounding errors are given to the largest weight so that flat areas stay flat
+        int16_t* fixed_weights = &weights_[static_cast<size_t>(position) * taps_];
+        int total = 0;
+        int largest = 0;
+        for (int k = 0; k < taps_; k++) {
+            fixed_weights[k] = static_cast<int16_t>(std::lround(weights[k] / sum * (1 << weight_bits)));
+            total += fixed_weights[k];
+            largest = fixed_weights[k] > fixed_weights[largest] ? k : largest;
+        }
+
+        fixed_weights[largest] = static_cast<int16_t>(fixed_weights[largest] + (1 << weight_bits) - total);
+        starts_[position] = start;
+    }
+}
+
+CdiTools::ScalerStage::ScalerStage(std::shared_ptr<VideoStream> source_stream, std::shared_ptr<VideoStream> rendition_stream,
+    ScalingFilter filter, RenditionHandler handler)
+    : name_{ "scale-" + std::to_string(rendition_stream->frame_width()) + "x" + std::to_string(rendition_stream->frame_height()) }
+    , source_stream_{ source_stream }
+    , rendition_stream_{ rendition_stream }
+    , horizontal_table_{ source_stream->frame_width(), rendition_stream->frame_width(), filter }
+    , vertical_table_{ source_stream->frame_height(), rendition_stream->frame_height(), filter }
+    , handler_{ handler }
+    , frames_scaled_{ 0 }
+    , scaling_errors_{ 0 }
+    , logger_{ "Scaler" }
+{
+    if (source_stream->bytes_per_pixel() != rendition_stream->bytes_per_pixel()) {
+        throw InvalidConfigurationException("Video stream #" + std::to_string(rendition_stream->id())
+            + " must have the same pixel size as the stream it is scaled from.");
+    }
+}
+
+CdiTools::Payload CdiTools::ScalerStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    // incomplete frames are passed on, but not scaled
+    if (payload->get_size() < source_stream_->payload_size()) return payload;
+
+    auto scaled_payload = scale(payload);
+    if (scaled_payload == nullptr) {
+        scaling_errors_++;
+        return payload;
+    }
+
+    frames_scaled_++;
+    handler_(scaled_payload);
+
+    return payload;
+}
+
+CdiTools::Payload CdiTools::ScalerStage::scale(Payload payload)
+{
+    // the pool is chosen by size, renditions take the smallest buffers that hold them
+    auto scaled_payload = PayloadData::create(rendition_stream_->id(), rendition_stream_->payload_size());
+    if (scaled_payload == nullptr) {
+        LOG_DEBUG << "Failed to allocate a buffer to scale a frame of stream #" << payload->stream_identifier()
+            << " for stream #" << rendition_stream_->id() << ".";
+        return nullptr;
+    }
+
+    scaled_payload->metadata().copy_from(payload->metadata());
+
+    static const bool is_avx2_available = ColorConversion::has_avx2();
+
+    int bytes_per_pixel = source_stream_->bytes_per_pixel();
+    size_t source_stride = static_cast<size_t>(source_stream_->frame_width()) * bytes_per_pixel;
+    int width = rendition_stream_->frame_width();
+    int height = rendition_stream_->frame_height();
+    int row_length = width * bytes_per_pixel;
+    int taps = vertical_table_.taps();
+    auto target = static_cast<uint8_t*>(scaled_payload->sgl_head_ptr->address_ptr);
+
+    // each band filters the source rows it needs horizontally, then combines them into its output rows
+    int bands = (height + band_height - 1) / band_height;
+    ThreadPool::instance().parallel_for(bands, [&](int band) {
+        thread_local std::vector<uint8_t> row_buffer;
+        thread_local std::vector<int16_t> filtered_rows;
+        thread_local std::vector<const int16_t*> rows;
+
+        int first_row = band * band_height;
+        int last_row = std::min(height, first_row + band_height) - 1;
+        int first_source_row = vertical_table_.start(first_row);
+        int source_rows = vertical_table_.start(last_row) + taps - first_source_row;
+        filtered_rows.resize(static_cast<size_t>(source_rows) * row_length);
+        rows.resize(taps);
+
+        for (int i = 0; i < source_rows; i++) {
+            // rows split across SGL entries are scaled from a scratch buffer
+            size_t offset = (first_source_row + i) * source_stride;
+            const uint8_t* source = PayloadRange::get_contiguous(*payload, offset, source_stride);
+            if (source == nullptr) {
+                row_buffer.resize(source_stride);
+                PayloadRange::read(*payload, offset, row_buffer.data(), source_stride);
+                source = row_buffer.data();
+            }
+
+            filter_horizontal(source, horizontal_table_, width, bytes_per_pixel, &filtered_rows[static_cast<size_t>(i) * row_length]);
+        }
+
+        for (int y = first_row; y <= last_row; y++) {
+            for (int k = 0; k < taps; k++) {
+                rows[k] = &filtered_rows[static_cast<size_t>(vertical_table_.start(y) - first_source_row + k) * row_length];
+            }
+
+            uint8_t* target_row = target + static_cast<size_t>(y) * row_length;
+            int done = 0;
+#ifdef USE_AVX2
+            if (is_avx2_available) {
+                done = filter_vertical_avx2(rows.data(), vertical_table_.weights(y), taps, target_row, row_length);
+            }
+#endif
+            filter_vertical(rows.data(), vertical_table_.weights(y), taps, target_row, done, row_length);
+        }
+    });
+
+    return scaled_payload;
+}
+
+std::string CdiTools::ScalerStage::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << "frames: " << frames_scaled_
+        << ", errors: " << scaling_errors_
+        << ", taps: " << horizontal_table_.taps() << "x" << vertical_table_.taps();
+
+    return statistics.str();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <functional>
+
+#include "IStage.h"
+#include "ScalingFilter.h"
+#include "VideoStream.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Taps of a separable resampling filter precomputed for every output position along one axis. Each
+    // position reads taps() consecutive source samples from start(), weights are fixed point and add up to
+    // 1 << weight_bits. When downscaling, the kernel is widened by the scale factor to also act as a low-pass.
+    class FilterTable
+    {
+    public:
+        static const int weight_bits = 14;
+
+        FilterTable(int source_size, int target_size, ScalingFilter filter);
+
+        inline int taps() const { return taps_; }
+        inline int start(int position) const { return starts_[position]; }
+        inline const int16_t* weights(int position) const { return &weights_[static_cast<size_t>(position) * taps_]; }
+
+    private:
+        int taps_;
+        std::vector<int> starts_;
+        std::vector<int16_t> weights_;
+    };
+
+    // Scales the frames of a video stream to the resolution of a rendition stream. Frames pass through
+    // unchanged, the scaled copy is handed over to be routed as a payload of the rendition stream. The
+    // stage is meant to sit on a branch of the source stream, off the path to its outputs.
+    class ScalerStage
+        : public IStage
+    {
+    public:
+        typedef std::function<void(Payload payload)> RenditionHandler;
+
+        ScalerStage(std::shared_ptr<VideoStream> source_stream, std::shared_ptr<VideoStream> rendition_stream,
+            ScalingFilter filter, RenditionHandler handler);
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Video; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Video; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+
+    private:
+        Payload scale(Payload payload);
+
+        std::string name_;
+        std::shared_ptr<VideoStream> source_stream_;
+        std::shared_ptr<VideoStream> rendition_stream_;
+        FilterTable horizontal_table_;
+        FilterTable vertical_table_;
+        RenditionHandler handler_;
+        std::atomic<int64_t> frames_scaled_;
+        std::atomic<int64_t> scaling_errors_;
+        Logger logger_;
+    };
+}
@@ -0,0 +1,7 @@
+#include "ScalingFilter.h"
+
+enum_map<CdiTools::ScalingFilter> CdiTools::scaling_filter_map{
+    { "Bilinear", ScalingFilter::Bilinear },
+    { "Bicubic", ScalingFilter::Bicubic },
+    { "Lanczos", ScalingFilter::Lanczos }
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Enum.h"
+
+namespace CdiTools
+{
+    // resampling filters of the video scaler, in increasing order of sharpness and cost
+    enum class ScalingFilter
+    {
+        Bilinear,
+        Bicubic,
+        Lanczos
+    };
+
+    extern enum_map<ScalingFilter> scaling_filter_map;
+}
@@ -0,0 +1,7 @@
+#include "SchedulingPolicy.h"
+
+enum_map<CdiTools::SchedulingPolicy> CdiTools::scheduling_policy_map{
+    { "Default", SchedulingPolicy::Default },
+    { "Fifo", SchedulingPolicy::Fifo },
+    { "RoundRobin", SchedulingPolicy::RoundRobin }
+};
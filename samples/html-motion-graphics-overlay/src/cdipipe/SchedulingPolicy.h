@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Enum.h"
+
+namespace CdiTools
+{
+    enum class SchedulingPolicy
+    {
+        Default,
+        Fifo,
+        RoundRobin
+    };
+
+    extern enum_map<SchedulingPolicy> scheduling_policy_map;
+}
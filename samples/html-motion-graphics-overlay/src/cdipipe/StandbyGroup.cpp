@@ -0,0 +1,165 @@
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "StandbyGroup.h"
+
+using namespace std::chrono;
+using namespace boost::interprocess;
+
+CdiTools::StandbyGroup::StandbyGroup(const std::string& name, milliseconds timeout, std::function<void()> fenced_handler)
+    : name_{ "cdipipe-" + name }
+    , timeout_{ timeout }
+    , shared_memory_{ open_or_create, name_.c_str(), read_write }
+    , block_{ nullptr }
+    , process_id_{ get_process_id() }
+    , is_primary_{ false }
+    , is_fenced_{ false }
+    , fenced_handler_{ fenced_handler }
+    , is_stopping_{ false }
+    , former_heartbeat_ns_{ 0 }
+    , detection_time_us_{ 0 }
+    , takeover_time_us_{ 0 }
+    , logger_{ "Standby" }
+{
+    // a new segment is zero filled, which is a liveness block without an owner
+    offset_t size = 0;
+    if (!shared_memory_.get_size(size) || size < static_cast<offset_t>(sizeof(LivenessBlock))) {
+        shared_memory_.truncate(sizeof(LivenessBlock));
+    }
+
+    region_ = mapped_region(shared_memory_, read_write, 0, sizeof(LivenessBlock));
+    block_ = static_cast<LivenessBlock*>(region_.get_address());
+}
+
+CdiTools::StandbyGroup::~StandbyGroup()
+{
+    is_stopping_ = true;
+    if (heartbeat_.joinable()) {
+        heartbeat_.join();
+    }
+
+    // hand over at once on a clean exit instead of waiting for the heartbeat to expire
+    int64_t owner_pid = process_id_;
+    block_->owner_pid.compare_exchange_strong(owner_pid, 0);
+}
+
+bool CdiTools::StandbyGroup::try_acquire()
+{
+    if (is_primary_) return true;
+
+    int64_t owner_pid = block_->owner_pid;
+    int64_t heartbeat_ns = block_->heartbeat_ns;
+    int64_t time_ns = now_ns();
+    bool is_expired = time_ns - heartbeat_ns > duration_cast<nanoseconds>(timeout_).count();
+    if (owner_pid != 0 && owner_pid != process_id_ && is_process_alive(owner_pid) && !is_expired) return false;
+
+    // another standby may be claiming the group at the same time
+    if (!block_->owner_pid.compare_exchange_strong(owner_pid, process_id_)) return false;
+
+    block_->heartbeat_ns = time_ns;
+    if (owner_pid != 0) {
+        block_->takeovers++;
+        former_heartbeat_ns_ = heartbeat_ns;
+        detection_time_us_ = (time_ns - heartbeat_ns) / 1000;
+        LOG_WARNING << "Primary process " << owner_pid << " of standby group '" << name_ << "' is "
+            << (is_expired ? "not responding" : "gone") << ", taking over " << detection_time_us_ / 1000 << " ms after its last heartbeat.";
+    }
+    else {
+        LOG_INFO << "Acting as the primary of standby group '" << name_ << "'.";
+    }
+
+    is_primary_ = true;
+    heartbeat_ = std::thread(&StandbyGroup::run_heartbeat, this);
+
+    return true;
+}
+
+bool CdiTools::StandbyGroup::wait_for_takeover(std::function<bool()> is_cancelled)
+{
+    LOG_INFO << "Standing by for process " << block_->owner_pid << " in standby group '" << name_ << "'...";
+
+    // a short poll interval keeps takeover well within a frame period
+    while (!try_acquire()) {
+        if (is_cancelled()) return false;
+
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+
+    return true;
+}
+
+void CdiTools::StandbyGroup::complete_takeover()
+{
+    if (former_heartbeat_ns_ == 0) return;
+
+    takeover_time_us_ = (now_ns() - former_heartbeat_ns_) / 1000;
+    LOG_INFO << "Takeover completed " << takeover_time_us_ / 1000 << "." << (takeover_time_us_ % 1000) / 100
+        << " ms after the last heartbeat of the former primary, failure detected after " << detection_time_us_ / 1000 << " ms.";
+}
+
+void CdiTools::StandbyGroup::run_heartbeat()
+{
+    auto interval = std::max(milliseconds(1), timeout_ / 5);
+    while (!is_stopping_) {
+        // a standby takes over a primary that missed its heartbeats, which must then stop acting as one
+        int64_t owner_pid = block_->owner_pid;
+        if (owner_pid != process_id_) {
+            is_primary_ = false;
+            is_fenced_ = true;
+            LOG_ERROR << "Standby group '" << name_ << "' was claimed by process " << owner_pid << ", giving up the primary role.";
+            if (fenced_handler_) {
+                fenced_handler_();
+            }
+
+            return;
+        }
+
+        block_->heartbeat_ns = now_ns();
+        std::this_thread::sleep_for(interval);
+    }
+}
+
+void CdiTools::StandbyGroup::show_status()
+{
+    LOG_INFO << "Standby group '" << name_ << "' - role: " << (is_primary_ ? "primary" : "standby")
+        << ", owner: " << block_->owner_pid
+        << ", takeovers: " << block_->takeovers
+        << ", last takeover: " << (takeover_time_us_ > 0 ? std::to_string(takeover_time_us_ / 1000) + " ms" : "none");
+}
+
+int64_t CdiTools::StandbyGroup::now_ns()
+{
+    // steady clock is system wide, so heartbeats compare across processes
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t CdiTools::StandbyGroup::get_process_id()
+{
+#ifdef _WIN32
+    return static_cast<int64_t>(GetCurrentProcessId());
+#else
+    return static_cast<int64_t>(getpid());
+#endif
+}
+
+bool CdiTools::StandbyGroup::is_process_alive(int64_t process_id)
+{
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(process_id));
+    if (process == NULL) return false;
+
+    bool is_alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+
+    return is_alive;
+#else
+    return kill(static_cast<pid_t>(process_id), 0) == 0 || errno != ESRCH;
+#endif
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <functional>
+
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Pairs a primary process with warm-standby processes started with the same group name. Members share
+    // a liveness block in shared memory: the primary stamps it with a heartbeat and a standby, which has
+    // already initialized its adapter and pools, polls it and claims the group as soon as the primary
+    // process is gone or its heartbeat stops, then opens the channel in its place. A primary that finds
+    // the group claimed by another process, e.g. after being suspended for longer than the timeout, is
+    // fenced: it stops its heartbeat and calls the fenced handler so that it shuts its channel down and exits.
+    class StandbyGroup
+    {
+    public:
+        StandbyGroup(const std::string& name, std::chrono::milliseconds timeout, std::function<void()> fenced_handler);
+        ~StandbyGroup();
+
+        // claims the group when no live primary holds it
+        bool try_acquire();
+        // waits until the group is claimed, returns false if cancelled
+        bool wait_for_takeover(std::function<bool()> is_cancelled);
+        // reports the time from the last heartbeat of the former primary until the first payload is delivered
+        void complete_takeover();
+        inline bool is_primary() const { return is_primary_; }
+        // the group was claimed by another process while this one was its primary
+        inline bool is_fenced() const { return is_fenced_; }
+        void show_status();
+
+    private:
+        struct LivenessBlock
+        {
+            std::atomic<int64_t> owner_pid;
+            std::atomic<int64_t> heartbeat_ns;
+            std::atomic<int64_t> takeovers;
+        };
+
+        static int64_t now_ns();
+        static int64_t get_process_id();
+        static bool is_process_alive(int64_t process_id);
+        void run_heartbeat();
+
+        std::string name_;
+        std::chrono::milliseconds timeout_;
+        boost::interprocess::shared_memory_object shared_memory_;
+        boost::interprocess::mapped_region region_;
+        LivenessBlock* block_;
+        int64_t process_id_;
+        std::atomic_bool is_primary_;
+        std::atomic_bool is_fenced_;
+        std::function<void()> fenced_handler_;
+        std::atomic_bool is_stopping_;
+        std::thread heartbeat_;
+        int64_t former_heartbeat_ns_;
+        int64_t detection_time_us_;
+        int64_t takeover_time_us_;
+        Logger logger_;
+    };
+}
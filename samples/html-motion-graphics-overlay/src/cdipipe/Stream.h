@@ -16,6 +16,11 @@ namespace CdiTools
             , payloads_received_{ 0 }
             , payloads_transmitted_{ 0 }
             , payload_errors_{ 0 }
+            , latency_samples_{ 0 }
+            , latency_total_us_{ 0 }
+            , latency_max_us_{ 0 }
+            , concealments_{ 0 }
+            , concealed_us_{ 0 }
         {
         }
 
@@ -28,6 +33,18 @@ namespace CdiTools
         inline int get_payloads_transmitted() { return payloads_transmitted_; }
         inline int payload_error() { return ++payload_errors_; }
         inline int get_payload_errors() { return payload_errors_; }
+        inline void latency_sample(int64_t latency_us)
+        {
+            ++latency_samples_;
+            latency_total_us_ += latency_us;
+            for (int64_t max_us = latency_max_us_; latency_us > max_us && !latency_max_us_.compare_exchange_weak(max_us, latency_us);) {}
+        }
+        inline int get_latency_samples() { return latency_samples_; }
+        inline int64_t get_average_latency_us() { return latency_samples_ > 0 ? latency_total_us_ / latency_samples_ : 0; }
+        inline int64_t get_max_latency_us() { return latency_max_us_; }
+        inline void concealment(int64_t duration_us) { ++concealments_; concealed_us_ += duration_us; }
+        inline int get_concealments() { return concealments_; }
+        inline int64_t get_concealed_us() { return concealed_us_; }
 
     private:
         uint16_t stream_identifier_;
@@ -35,5 +52,10 @@ namespace CdiTools
         std::atomic_int payloads_received_;
         std::atomic_int payloads_transmitted_;
         std::atomic_int payload_errors_;
+        std::atomic_int latency_samples_;
+        std::atomic<int64_t> latency_total_us_;
+        std::atomic<int64_t> latency_max_us_;
+        std::atomic_int concealments_;
+        std::atomic<int64_t> concealed_us_;
     };
 }
@@ -0,0 +1,428 @@
+#include <boost/asio.hpp>
+
+#include "StripedTcpConnection.h"
+#include "Errors.h"
+#include "Stream.h"
+#include "Exceptions.h"
+
+using namespace boost::asio;
+using namespace boost::asio::ip;
+using asio_error = boost::system::error_code;
+
+namespace
+{
+    const uint32_t chunk_magic = 0x53494443;      // "CDIS"
+
+    // builds the buffer sequence for a range of bytes in a payload scatter-gather list
+    template <typename TBuffer>
+    bool get_payload_range(const CdiSgList& sgl, size_t offset, size_t length, std::vector<TBuffer>& buffers)
+    {
+        for (CdiSglEntry* sgl_entry_ptr = sgl.sgl_head_ptr;
+            sgl_entry_ptr != nullptr && length > 0; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
+            size_t entry_size = static_cast<size_t>(sgl_entry_ptr->size_in_bytes);
+            if (offset >= entry_size) {
+                offset -= entry_size;
+                continue;
+            }
+
+            size_t size = std::min(entry_size - offset, length);
+            buffers.push_back(TBuffer{ static_cast<char*>(sgl_entry_ptr->address_ptr) + offset, size });
+            length -= size;
+            offset = 0;
+        }
+
+        return length == 0;
+    }
+
+    // transfers the whole chunk without splitting it into operations of the default ASIO size
+    auto transfer_chunk(std::size_t chunk_size)
+    {
+        return [chunk_size](const asio_error& ec, std::size_t bytes_transferred) -> std::size_t {
+            return !ec && bytes_transferred < chunk_size ? chunk_size - bytes_transferred : 0;
+        };
+    }
+}
+
+CdiTools::StripedTcpConnection::StripedTcpConnection(const std::string& name, const std::string& host_name, unsigned short port_number,
+    ConnectionMode connection_mode, ConnectionDirection connection_direction, int buffer_size, int stripes, io_context& io)
+    : Connection(name, host_name, port_number, connection_mode, connection_direction, buffer_size, io)
+    , stripes_{ stripes }
+    , transmit_sequence_{ 0 }
+    , receive_sequence_{ 0 }
+{
+    if (stripes_ < 1) {
+        throw InvalidConfigurationException(std::string("Striped TCP connection '" + name_ + "' requires at least one socket."));
+    }
+
+    for (int i = 0; i < stripes_; i++) {
+        sockets_.push_back(std::make_unique<tcp::socket>(io_));
+    }
+}
+
+CdiTools::StripedTcpConnection::~StripedTcpConnection()
+{
+    LOG_TRACE << "Striped TCP Connection '" << name_ << "' is being destroyed...";
+}
+
+void CdiTools::StripedTcpConnection::async_connect(ConnectHandler handler)
+{
+    if (is_connected()) {
+        notify_connection_change(handler, connection_error::already_connected);
+        return;
+    }
+
+    LOG_DEBUG << "Waiting to establish " << stripes_ << " TCP connections to " << host_name_ << ":" << port_number_ << "...";
+    set_status(ConnectionStatus::Connecting);
+    auto resolver = std::make_shared<tcp::resolver>(io_);
+    tcp::resolver::query query(host_name_, std::to_string(port_number_));
+
+    resolver->async_resolve(query, [&, resolver, handler](const asio_error& ec, tcp::resolver::results_type results)
+    {
+        if (ec) {
+            LOG_DEBUG << "TCP connection failure: " << ec.message() << ", code: " << ec.value() << ".";
+            set_status(ConnectionStatus::Closed);
+            notify_connection_change(handler, ec);
+            return;
+        }
+
+        auto transfer = std::make_shared<Transfer>(stripes_, 0);
+        for (auto&& socket : sockets_) {
+            boost::asio::async_connect(*socket, results.begin(), [&, transfer, handler](const asio_error& ec, tcp::resolver::iterator) {
+                connect_complete(transfer, handler, ec);
+            });
+        }
+    });
+}
+
+void CdiTools::StripedTcpConnection::async_accept(ConnectHandler handler)
+{
+    if (is_connected()) {
+        notify_connection_change(handler, connection_error::already_connected);
+        return;
+    }
+
+    LOG_DEBUG << "Listening for " << stripes_ << " TCP connections at " << host_name_ << ":" << port_number_ << "...";
+
+    // striped connections are meant to cross hosts, so listen on every interface unless a local endpoint is given
+    asio_error err;
+    auto address = make_address(host_name_, err);
+    tcp::endpoint endpoint(!err && address.is_loopback() ? address : address_v4::any(), port_number_);
+
+    set_status(ConnectionStatus::Connecting);
+    auto acceptor = std::make_shared<tcp::acceptor>(io_, endpoint);
+    accept_stripe(acceptor, 0, handler);
+}
+
+void CdiTools::StripedTcpConnection::accept_stripe(std::shared_ptr<tcp::acceptor> acceptor, int stripe, ConnectHandler handler)
+{
+    acceptor->async_accept(*sockets_[stripe], [&, acceptor, stripe, handler](const asio_error& ec) {
+        if (ec) {
+            LOG_DEBUG << "TCP connection failure: " << ec.message() << ", code: " << ec.value() << ".";
+            close_on_error(ec);
+            set_status(ConnectionStatus::Closed);
+            notify_connection_change(handler, ec);
+            return;
+        }
+
+        LOG_DEBUG << "TCP connection " << stripe + 1 << "/" << stripes_ << " accepted from " << sockets_[stripe]->remote_endpoint() << ".";
+        if (stripe + 1 < stripes_) {
+            accept_stripe(acceptor, stripe + 1, handler);
+            return;
+        }
+
+        for (auto&& socket : sockets_) {
+            socket_settings_ = TcpConnection::tune_socket(*socket, streams_[0], logger_);
+        }
+
+        receive_sequence_ = 0;
+        set_status(ConnectionStatus::Open);
+        notify_connection_change(handler, std::error_code());
+    });
+}
+
+void CdiTools::StripedTcpConnection::connect_complete(std::shared_ptr<Transfer> transfer, ConnectHandler handler, const std::error_code& ec)
+{
+    if (ec) {
+        std::lock_guard<std::mutex> lock(transfer->gate);
+        if (!transfer->error) {
+            transfer->error = ec;
+        }
+    }
+
+    if (--transfer->pending > 0) return;
+
+    if (transfer->error) {
+        LOG_ERROR << "TCP connection failure: " << transfer->error.message() << ", code: " << transfer->error.value() << ".";
+        close_on_error(transfer->error);
+        set_status(ConnectionStatus::Closed);
+        notify_connection_change(handler, transfer->error);
+        return;
+    }
+
+    for (auto&& socket : sockets_) {
+        socket_settings_ = TcpConnection::tune_socket(*socket, streams_[0], logger_);
+    }
+
+    LOG_DEBUG << stripes_ << " TCP connections to " << sockets_[0]->remote_endpoint() << " were established.";
+    transmit_sequence_ = 0;
+    set_status(ConnectionStatus::Open);
+    notify_connection_change(handler, std::error_code());
+}
+
+void CdiTools::StripedTcpConnection::disconnect(std::error_code& ec)
+{
+    for (auto&& socket : sockets_) {
+        asio_error err;
+        if (socket->is_open()) {
+            socket->shutdown(socket_base::shutdown_both, err);
+        }
+
+        socket->close(err);
+        if (err) {
+            ec = err;
+            LOG_DEBUG << "TCP connection close failure: " << ec.message() << ", code: " << ec.value() << ".";
+        }
+    }
+
+    if (get_status() == ConnectionStatus::Open) {
+        LOG_DEBUG << stripes_ << " TCP connections to " << host_name_ << ":" << port_number_ << " were closed.";
+    }
+
+    set_status(ConnectionStatus::Closed);
+}
+
+void CdiTools::StripedTcpConnection::close_on_error(const std::error_code& ec)
+{
+    // closing every socket aborts the operations still pending on the other stripes
+    std::error_code err;
+    disconnect(err);
+}
+
+void CdiTools::StripedTcpConnection::async_receive(ReceiveHandler handler)
+{
+    if (!is_connected()) {
+        notify_payload_received(handler, connection_error::not_connected, nullptr);
+        return;
+    }
+
+    auto& default_stream = streams_[0];
+    auto payload = PayloadData::create(default_stream->id(), default_stream->payload_size());
+    if (payload == nullptr) {
+        auto payload_errors = ++payload_errors_;
+        LOG_DEBUG << "Failed to obtain a payload buffer for #" << default_stream->id() << ":" << payloads_received_ + 1
+            << ", size " << default_stream->payload_size()
+            << " from the pool, total errors : " << payload_errors << ".";
+
+        notify_payload_received(handler, connection_error::no_buffer_space, payload);
+        return;
+    }
+
+    LOG_TRACE << "Striped TCP waiting for payload #" << payload->stream_identifier() << ":" << payloads_received_ + 1
+#ifdef TRACE_PAYLOADS
+        << " (" << payload->sequence() << ")"
+#endif
+        << "...";
+
+    auto transfer = std::make_shared<Transfer>(stripes_, receive_sequence_);
+    for (int socket_index = 0; socket_index < stripes_; socket_index++) {
+        read_chunk(transfer, socket_index, payload, handler);
+    }
+}
+
+void CdiTools::StripedTcpConnection::set_socket_dispatcher(SocketDispatcher dispatcher)
+{
+    socket_dispatcher_ = dispatcher;
+}
+
+void CdiTools::StripedTcpConnection::dispatch(int socket_index, std::function<void()> handler)
+{
+    if (socket_dispatcher_) {
+        socket_dispatcher_(socket_index, handler);
+    }
+    else {
+        handler();
+    }
+}
+
+void CdiTools::StripedTcpConnection::read_chunk(std::shared_ptr<Transfer> transfer, int socket_index, Payload payload, ReceiveHandler handler)
+{
+    auto& header = transfer->headers[socket_index];
+    async_read(*sockets_[socket_index], buffer(&header, sizeof(header)), [&, transfer, socket_index, payload, handler](const asio_error& ec, std::size_t) {
+        dispatch(socket_index, [&, transfer, socket_index, payload, handler, ec]() {
+            if (ec) {
+                receive_complete(transfer, payload, handler, ec);
+                return;
+            }
+
+            read_chunk_data(transfer, socket_index, payload, handler);
+        });
+    });
+}
+
+void CdiTools::StripedTcpConnection::read_chunk_data(std::shared_ptr<Transfer> transfer, int socket_index, Payload payload, ReceiveHandler handler)
+{
+    // the header must describe the chunk the transmitter cuts for its stripe from a payload that fits the
+    // buffer, chunks then land directly at their offset in the destination payload buffer
+    auto& header = transfer->headers[socket_index];
+    uint32_t chunk_size = (header.payload_size + stripes_ - 1) / stripes_;
+    uint32_t chunk_offset = std::min(header.payload_size, static_cast<uint32_t>(header.stripe) * chunk_size);
+    std::vector<mutable_buffer> sgl;
+    if (header.magic != chunk_magic || header.sequence != transfer->sequence || header.stripe >= stripes_
+        || header.payload_size > static_cast<uint32_t>(payload->get_size())
+        || header.offset != chunk_offset || header.length != std::min(chunk_size, header.payload_size - chunk_offset)
+        || !get_payload_range(*payload, header.offset, header.length, sgl)) {
+        LOG_ERROR << "Invalid chunk header received for payload #" << transfer->sequence << ", stripe " << header.stripe
+            << ", sequence: " << header.sequence << ", offset: " << header.offset << ", length: " << header.length << ".";
+        receive_complete(transfer, payload, handler, connection_error::receive_error);
+        return;
+    }
+
+    async_read(*sockets_[socket_index], sgl, transfer_chunk(header.length), [&, transfer, socket_index, payload, handler](const asio_error& ec, std::size_t) {
+        dispatch(socket_index, [&, transfer, payload, handler, ec]() { receive_complete(transfer, payload, handler, ec); });
+    });
+}
+
+void CdiTools::StripedTcpConnection::receive_complete(std::shared_ptr<Transfer> transfer, Payload payload, ReceiveHandler handler, const std::error_code& ec)
+{
+    if (ec) {
+        bool is_first_error = false;
+        {
+            std::lock_guard<std::mutex> lock(transfer->gate);
+            is_first_error = !transfer->error;
+            if (is_first_error) {
+                transfer->error = ec;
+            }
+        }
+
+        if (is_first_error) {
+            close_on_error(ec);
+        }
+    }
+
+    if (--transfer->pending > 0) return;
+
+    // every stripe must be received exactly once, carrying a chunk of the same payload
+    if (!transfer->error) {
+        std::vector<bool> stripes_received(stripes_, false);
+        for (auto&& header : transfer->headers) {
+            if (header.payload_size != transfer->headers[0].payload_size || header.stream_identifier != transfer->headers[0].stream_identifier
+                || stripes_received[header.stripe]) {
+                LOG_ERROR << "Inconsistent chunk headers received for payload #" << transfer->sequence << ", stripe " << header.stripe
+                    << ", payload size: " << header.payload_size << " instead of " << transfer->headers[0].payload_size << ".";
+                transfer->error = make_error_code(connection_error::receive_error);
+                close_on_error(transfer->error);
+                break;
+            }
+
+            stripes_received[header.stripe] = true;
+        }
+    }
+
+    auto payloads_received = ++payloads_received_;
+    if (transfer->error) {
+        auto payload_errors = ++payload_errors_;
+        LOG_DEBUG << "Striped TCP receive failure: " << transfer->error.message() << ", code: " << transfer->error.value()
+            << ", total errors: " << payload_errors << ".";
+        payload->set_size(0);
+        notify_payload_received(handler, transfer->error, payload);
+        return;
+    }
+
+    receive_sequence_ = transfer->sequence + 1;
+    payload->set_size(static_cast<int>(transfer->headers[0].payload_size));
+
+    LOG_TRACE << "Striped TCP received payload #" << payload->stream_identifier() << "/" << payloads_received
+#ifdef TRACE_PAYLOADS
+        << " (" << payload->sequence() << ")"
+#endif
+        << ", size:" << payload->get_size() << "...";
+
+    notify_payload_received(handler, std::error_code(), payload);
+}
+
+void CdiTools::StripedTcpConnection::async_transmit(Payload payload, TransmitHandler handler)
+{
+    if (!is_connected()) {
+        notify_payload_transmitted(handler, connection_error::not_connected);
+        return;
+    }
+
+    LOG_TRACE << "Striped TCP transmitting payload #" << payload->stream_identifier() << ":" << payloads_transmitted_ + 1
+#ifdef TRACE_PAYLOADS
+        << " (" << payload->sequence() << ")"
+#endif
+        << "...";
+
+    // split the payload evenly across sockets, sending an empty chunk when there is nothing left for a stripe
+    auto transfer = std::make_shared<Transfer>(stripes_, transmit_sequence_++);
+    uint32_t payload_size = static_cast<uint32_t>(payload->get_size());
+    uint32_t chunk_size = (payload_size + stripes_ - 1) / stripes_;
+    for (int stripe = 0; stripe < stripes_; stripe++) {
+        auto& header = transfer->headers[stripe];
+        header.magic = chunk_magic;
+        header.sequence = transfer->sequence;
+        header.payload_size = payload_size;
+        header.offset = std::min(payload_size, stripe * chunk_size);
+        header.length = std::min(chunk_size, payload_size - header.offset);
+        header.stream_identifier = payload->stream_identifier();
+        header.stripe = static_cast<uint16_t>(stripe);
+
+        std::vector<const_buffer> sgl{ buffer(&header, sizeof(header)) };
+        get_payload_range(*payload, header.offset, header.length, sgl);
+        async_write(*sockets_[stripe], sgl, transfer_chunk(sizeof(header) + header.length),
+            [&, transfer, stripe, payload, handler](const asio_error& ec, std::size_t) {
+                dispatch(stripe, [&, transfer, payload, handler, ec]() { transmit_complete(transfer, payload, handler, ec); });
+            });
+    }
+}
+
+void CdiTools::StripedTcpConnection::transmit_complete(std::shared_ptr<Transfer> transfer, Payload payload, TransmitHandler handler, const std::error_code& ec)
+{
+    if (ec) {
+        bool is_first_error = false;
+        {
+            std::lock_guard<std::mutex> lock(transfer->gate);
+            is_first_error = !transfer->error;
+            if (is_first_error) {
+                transfer->error = ec;
+            }
+        }
+
+        if (is_first_error) {
+            close_on_error(ec);
+        }
+    }
+
+    if (--transfer->pending > 0) return;
+
+    auto payloads_transmitted = ++payloads_transmitted_;
+    if (transfer->error) {
+        auto payload_errors = ++payload_errors_;
+        LOG_DEBUG << "Striped TCP transmit failure: " << transfer->error.message() << ", code: " << transfer->error.value()
+            << ", total errors: " << payload_errors << ".";
+    }
+    else {
+        LOG_TRACE << "Striped TCP transmitted payload #" << payload->stream_identifier() << ":" << payloads_transmitted
+#ifdef TRACE_PAYLOADS
+            << " (" << payload->sequence() << ")"
+#endif
+            << "...";
+    }
+
+    notify_payload_transmitted(handler, transfer->error);
+}
+
+void CdiTools::StripedTcpConnection::add_stream(std::shared_ptr<Stream> stream)
+{
+    if (streams_.size() > 0) {
+        throw InvalidConfigurationException(
+            std::string("TCP connection '" + name_ + "' has already been assigned to stream [" + std::to_string(streams_[0]->id()) + "]. TCP connections support a single stream only."));
+    }
+
+    Connection::add_stream(stream);
+}
+
+std::string CdiTools::StripedTcpConnection::get_statistics() const
+{
+    return "stripes: " + std::to_string(stripes_) + ", " + TcpConnection::format_settings(socket_settings_);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <mutex>
+#include <functional>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "Connection.h"
+#include "TcpConnection.h"
+
+namespace CdiTools
+{
+    // Spreads each payload over several parallel TCP sockets. Every payload is split into one chunk per
+    // socket, preceded by a header with its stripe and offset, and the chunks are reassembled on the receiver
+    // side directly into the destination pool buffer. Sockets are accepted in any order, each chunk is placed
+    // by the stripe in its header. The completions of each socket can be run by an executor of its own.
+    class StripedTcpConnection
+        : public Connection
+    {
+    public:
+        typedef std::function<void(int socket_index, std::function<void()> handler)> SocketDispatcher;
+
+        StripedTcpConnection(const std::string& name, const std::string& host_name, unsigned short port_number,
+            ConnectionMode connection_mode, ConnectionDirection connection_direction, int buffer_size, int stripes, boost::asio::io_context& io);
+        ~StripedTcpConnection() override;
+
+        void async_connect(ConnectHandler handler) override;
+        void async_accept(ConnectHandler handler) override;
+        void disconnect(std::error_code& ec) override;
+        void async_receive(ReceiveHandler handler) override;
+        void async_transmit(Payload payload, TransmitHandler handler) override;
+        inline ConnectionType get_type() const override { return ConnectionType::StripedTcp; }
+        void add_stream(std::shared_ptr<Stream> stream) override;
+        std::string get_statistics() const override;
+        inline int get_stripes() const { return stripes_; }
+        // must be set before the connection is opened
+        void set_socket_dispatcher(SocketDispatcher dispatcher);
+
+    private:
+#pragma pack(push, 1)
+        struct ChunkHeader
+        {
+            uint32_t magic;
+            uint32_t sequence;
+            uint32_t payload_size;
+            uint32_t offset;
+            uint32_t length;
+            uint16_t stream_identifier;
+            uint16_t stripe;
+        };
+#pragma pack(pop)
+
+        // state shared by the per-socket operations that transfer a single payload
+        struct Transfer
+        {
+            Transfer(int stripes, uint32_t sequence) : headers(stripes), sequence{ sequence }, pending{ stripes } {}
+            std::vector<ChunkHeader> headers;
+            uint32_t sequence;
+            std::atomic_int pending;
+            std::mutex gate;
+            std::error_code error;
+        };
+
+        void accept_stripe(std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor, int stripe, ConnectHandler handler);
+        void connect_complete(std::shared_ptr<Transfer> transfer, ConnectHandler handler, const std::error_code& ec);
+        void read_chunk(std::shared_ptr<Transfer> transfer, int socket_index, Payload payload, ReceiveHandler handler);
+        void read_chunk_data(std::shared_ptr<Transfer> transfer, int socket_index, Payload payload, ReceiveHandler handler);
+        void dispatch(int socket_index, std::function<void()> handler);
+        void receive_complete(std::shared_ptr<Transfer> transfer, Payload payload, ReceiveHandler handler, const std::error_code& ec);
+        void transmit_complete(std::shared_ptr<Transfer> transfer, Payload payload, TransmitHandler handler, const std::error_code& ec);
+        void close_on_error(const std::error_code& ec);
+
+        int stripes_;
+        std::vector<std::unique_ptr<boost::asio::ip::tcp::socket>> sockets_;
+        uint32_t transmit_sequence_;
+        uint32_t receive_sequence_;
+        TcpConnection::SocketSettings socket_settings_;
+        SocketDispatcher socket_dispatcher_;
+    };
+}
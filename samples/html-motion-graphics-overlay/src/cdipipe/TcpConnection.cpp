@@ -1,18 +1,94 @@
+#include <limits>
+
 #include <boost/asio.hpp>
 
+#ifndef _WIN32
+#include <netinet/tcp.h>
+#endif
+
 #include "TcpConnection.h"
+#include "Configuration.h"
 #include "Errors.h"
 #include "Stream.h"
+#include "VideoStream.h"
 #include "Exceptions.h"
+#include "PayloadRange.h"
 
 using namespace boost::asio;
 using namespace boost::asio::ip;
 using asio_error = boost::system::error_code;
 
+namespace
+{
+    // time span of payloads that the kernel socket buffers should be able to hold
+    const int socket_buffer_duration_ms = 100;
+    const int minimum_buffered_payloads = 2;
+    const int maximum_socket_buffer_size = 64 * 1024 * 1024;
+
+    // least number of bytes read before a range of a payload forwarded as it arrives is completed
+    const std::size_t cut_through_range_size = 64 * 1024;
+
+    // written in place of the missing bytes of an aborted payload whose leading bytes were already sent
+    const std::vector<uint8_t> padding(64 * 1024);
+
+    // size kernel buffers to hold the payloads produced over a period of time, at least a few of them
+    int get_socket_buffer_size(std::shared_ptr<CdiTools::Stream> stream)
+    {
+        int buffered_payloads = minimum_buffered_payloads;
+        auto video_stream = std::dynamic_pointer_cast<CdiTools::VideoStream>(stream);
+        if (video_stream != nullptr && video_stream->frame_rate_denominator() > 0) {
+            int frames = (socket_buffer_duration_ms * video_stream->frame_rate_numerator()
+                + 1000 * video_stream->frame_rate_denominator() - 1) / (1000 * video_stream->frame_rate_denominator());
+            buffered_payloads = std::max(buffered_payloads, frames);
+        }
+
+        return static_cast<int>(std::min<int64_t>(maximum_socket_buffer_size,
+            static_cast<int64_t>(stream->payload_size()) * buffered_payloads));
+    }
+
+    // returns a completion condition that transfers the whole payload, counting the number of
+    // read or write operations (i.e. system calls) required. Unless tuning is enabled, each operation
+    // is limited to the default ASIO transfer size, which splits large frames into many system calls.
+    auto transfer_payload(std::size_t payload_size, std::atomic_int& operations)
+    {
+        return [payload_size, &operations](const asio_error& ec, std::size_t bytes_transferred) -> std::size_t {
+            std::size_t remaining = !ec && bytes_transferred < payload_size ? payload_size - bytes_transferred : 0;
+            if (!CdiTools::Configuration::tcp_autotune) {
+                remaining = std::min<std::size_t>(remaining, boost::asio::detail::default_max_transfer_size);
+            }
+
+            if (remaining > 0) {
+                ++operations;
+            }
+
+            return remaining;
+        };
+    }
+
+    // returns a completion condition that transfers at least the given range size, or the remaining
+    // buffer space if smaller, each operation taking as much as the socket holds
+    auto transfer_range(std::size_t range_size, std::size_t buffer_space, std::atomic_int& operations)
+    {
+        return [range_size, buffer_space, &operations](const asio_error& ec, std::size_t bytes_transferred) -> std::size_t {
+            if (ec || bytes_transferred >= std::min(range_size, buffer_space)) {
+                return 0;
+            }
+
+            ++operations;
+
+            return buffer_space - bytes_transferred;
+        };
+    }
+}
+
 CdiTools::TcpConnection::TcpConnection(const std::string& name, const std::string& host_name, unsigned short port_number,
     ConnectionMode connection_mode, ConnectionDirection connection_direction, int buffer_size, io_context& io)
     : Connection(name, host_name, port_number, connection_mode, connection_direction, buffer_size, io)
     , socket_{ io }
+    , read_operations_{ 0 }
+    , write_operations_{ 0 }
+    , padded_payloads_{ 0 }
+    , dropped_payloads_{ 0 }
 {
 }
 
@@ -47,6 +123,7 @@ void CdiTools::TcpConnection::async_connect(ConnectHandler handler)
             set_status(ec ? ConnectionStatus::Closed : ConnectionStatus::Open);
             if (is_connected()) {
                 LOG_DEBUG << "TCP connection to " << socket_.remote_endpoint() << " was established.";
+                socket_settings_ = tune_socket(socket_, streams_[0], logger_);
             }
             else {
                 LOG_ERROR << "TCP connection failure: " << ec.message() << ", code: " << ec.value() << ".";
@@ -69,10 +146,17 @@ void CdiTools::TcpConnection::async_accept(ConnectHandler handler)
     set_status(ConnectionStatus::Connecting);
     tcp::endpoint endpoint(address_v4::loopback(), port_number_);
     auto acceptor = std::make_shared<tcp::acceptor>(io_, endpoint);
+    if (Configuration::tcp_autotune) {
+        // receive buffer size must be set before accepting for a suitable TCP window scale to be negotiated
+        asio_error err;
+        acceptor->set_option(socket_base::receive_buffer_size(get_socket_buffer_size(streams_[0])), err);
+    }
+
     acceptor->async_accept(socket_, [&, acceptor, handler](const asio_error& ec) {
         set_status(ec ? ConnectionStatus::Closed : ConnectionStatus::Open);
         if (is_connected()) {
             LOG_DEBUG << "TCP connection accepted from " << socket_.remote_endpoint() << ".";
+            socket_settings_ = tune_socket(socket_, streams_[0], logger_);
         }
         else {
             LOG_DEBUG << "TCP connection failure: " << ec.message() << ", code: " << ec.value() << ".";
@@ -113,6 +197,18 @@ void CdiTools::TcpConnection::async_receive(ReceiveHandler handler)
         return;
     }
 
+    // a payload handed over before it was complete is still being read, the next one follows once it is settled
+    if (receiving_progress_ != nullptr) {
+        if (!receiving_progress_->is_settled()) {
+            receiving_progress_->async_wait(std::numeric_limits<size_t>::max(), [&, handler]() {
+                post(io_, [&, handler]() { async_receive(handler); });
+            });
+            return;
+        }
+
+        receiving_progress_ = nullptr;
+    }
+
     auto& default_stream = streams_[0];
     auto payload = PayloadData::create(default_stream->id(), default_stream->payload_size());
     if (payload == nullptr) {
@@ -128,6 +224,13 @@ void CdiTools::TcpConnection::async_receive(ReceiveHandler handler)
         return;
     }
 
+    if (Configuration::cut_through && default_stream->get_type() == PayloadType::Video) {
+        receiving_progress_ = std::make_shared<PayloadProgress>(payload->get_size());
+        payload->set_progress(receiving_progress_);
+        receive_range(payload, 0, handler);
+        return;
+    }
+
     std::vector<mutable_buffer> sgl;
     for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr;
         sgl_entry_ptr != nullptr; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
@@ -165,13 +268,62 @@ void CdiTools::TcpConnection::async_receive(ReceiveHandler handler)
         << "...";
 
     if (default_stream->get_type() == PayloadType::Video) {
-        async_read(socket_, sgl, read_complete);
+        async_read(socket_, sgl, transfer_payload(buffer_size(sgl), read_operations_), read_complete);
     }
     else {
+        ++read_operations_;
         socket_.async_read_some(sgl, read_complete);
     }
 }
 
+void CdiTools::TcpConnection::receive_range(Payload payload, size_t offset, ReceiveHandler handler)
+{
+    size_t payload_size = static_cast<size_t>(payload->get_size());
+    std::vector<mutable_buffer> sgl;
+    PayloadRange::for_each(*payload, offset, payload_size - offset, [&](uint8_t* data, size_t, size_t length) {
+        sgl.push_back(mutable_buffer{ data, length });
+    });
+
+    async_read(socket_, sgl, transfer_range(cut_through_range_size, payload_size - offset, read_operations_),
+        [&, payload, offset, payload_size, handler](const asio_error& ec, std::size_t bytes_received) {
+        auto progress = payload->progress();
+        progress->complete_range(offset, bytes_received);
+
+        // the payload is handed over with its first range, outputs follow the progress of the rest
+        if (offset == 0 && bytes_received > 0) {
+            auto payloads_received = ++payloads_received_;
+            LOG_TRACE << "TCP receiving payload #" << payload->stream_identifier() << "/" << payloads_received
+#ifdef TRACE_PAYLOADS
+                << " (" << payload->sequence() << ")"
+#endif
+                << "...";
+
+            notify_payload_received(handler, std::error_code(), payload);
+        }
+
+        if (ec) {
+            auto payload_errors = ++payload_errors_;
+            LOG_DEBUG << "TCP receive failure after " << offset + bytes_received << " of " << payload_size << " bytes: "
+                << ec.message() << ", code: " << ec.value() << ", total errors: " << payload_errors << ".";
+            if (error::connection_reset == ec || error::connection_aborted == ec || error::eof == ec) {
+                std::error_code err;
+                disconnect(err);
+            }
+
+            progress->abort();
+            return;
+        }
+
+        if (offset + bytes_received < payload_size) {
+            receive_range(payload, offset + bytes_received, handler);
+            return;
+        }
+
+        LOG_TRACE << "TCP received payload #" << payload->stream_identifier() << "/" << payloads_received_
+            << ", size:" << payload_size << "...";
+    });
+}
+
 void CdiTools::TcpConnection::async_transmit(Payload payload, TransmitHandler handler)
 {
     if (!is_connected()) {
@@ -179,6 +331,13 @@ void CdiTools::TcpConnection::async_transmit(Payload payload, TransmitHandler ha
         return;
     }
 
+    // a payload still being received is sent in ranges as they complete
+    auto progress = payload->progress();
+    if (progress != nullptr && PayloadProgress::State::Complete != progress->get_state()) {
+        transmit_range(payload, 0, handler);
+        return;
+    }
+
     std::vector<const_buffer> sgl;
     for (CdiSglEntry* sgl_entry_ptr = payload->sgl_head_ptr;
         sgl_entry_ptr != nullptr; sgl_entry_ptr = sgl_entry_ptr->next_ptr) {
@@ -190,7 +349,7 @@ void CdiTools::TcpConnection::async_transmit(Payload payload, TransmitHandler ha
         << " (" << payload->sequence() << ")"
 #endif
         << "...";
-    async_write(socket_, sgl, [&, payload, handler](const asio_error& ec, std::size_t bytes_transferred) {
+    async_write(socket_, sgl, transfer_payload(buffer_size(sgl), write_operations_), [&, payload, handler](const asio_error& ec, std::size_t bytes_transferred) {
         auto payloads_transmitted = ++payloads_transmitted_;
         if (ec) {
             auto payload_errors = ++payload_errors_;
@@ -212,6 +371,81 @@ void CdiTools::TcpConnection::async_transmit(Payload payload, TransmitHandler ha
     });
 }
 
+void CdiTools::TcpConnection::transmit_range(Payload payload, size_t offset, TransmitHandler handler)
+{
+    // progress handlers run on the thread that receives the payload, ranges are sent from this connection's context
+    payload->progress()->async_wait(offset, [&, payload, offset, handler]() {
+        post(io_, [&, payload, offset, handler]() {
+            if (!is_connected()) {
+                notify_payload_transmitted(handler, connection_error::not_connected);
+                return;
+            }
+
+            auto progress = payload->progress();
+            size_t payload_size = static_cast<size_t>(payload->get_size());
+            size_t completed_size = progress->get_completed_size();
+            bool is_padded = false;
+            std::vector<const_buffer> sgl;
+            if (completed_size > offset) {
+                PayloadRange::for_each(*payload, offset, completed_size - offset, [&](uint8_t* data, size_t, size_t length) {
+                    sgl.push_back(const_buffer{ data, length });
+                });
+            }
+            else if (offset == 0) {
+                // aborted before any of it was sent
+                auto dropped_payloads = ++dropped_payloads_;
+                LOG_DEBUG << "TCP dropped payload #" << payload->stream_identifier() << " aborted by its input"
+                    << ", total dropped: " << dropped_payloads << ".";
+                notify_payload_transmitted(handler, connection_error::payload_aborted);
+                return;
+            }
+            else {
+                // bytes sent cannot be taken back, the rest is padded to keep the receiver aligned on payload boundaries
+                for (size_t remaining = payload_size - offset; remaining > 0;) {
+                    size_t length = std::min(remaining, padding.size());
+                    sgl.push_back(const_buffer{ padding.data(), length });
+                    remaining -= length;
+                }
+
+                is_padded = true;
+            }
+
+            async_write(socket_, sgl, transfer_payload(buffer_size(sgl), write_operations_),
+                [&, payload, offset, payload_size, is_padded, handler](const asio_error& ec, std::size_t bytes_transferred) {
+                if (ec) {
+                    auto payload_errors = ++payload_errors_;
+                    LOG_DEBUG << "TCP transmit failure: " << ec.message() << ", code: " << ec.value() << ", total errors: " << payload_errors << ".";
+                    if (error::connection_reset == ec || error::connection_aborted == ec || error::eof == ec) {
+                        std::error_code err;
+                        disconnect(err);
+                    }
+
+                    ++payloads_transmitted_;
+                    notify_payload_transmitted(handler, ec);
+                    return;
+                }
+
+                if (offset + bytes_transferred < payload_size) {
+                    transmit_range(payload, offset + bytes_transferred, handler);
+                    return;
+                }
+
+                auto payloads_transmitted = ++payloads_transmitted_;
+                if (is_padded) {
+                    auto padded_payloads = ++padded_payloads_;
+                    LOG_DEBUG << "TCP padded payload #" << payload->stream_identifier() << ":" << payloads_transmitted
+                        << " aborted by its input after " << offset << " bytes, total padded: " << padded_payloads << ".";
+                    notify_payload_transmitted(handler, connection_error::payload_aborted);
+                    return;
+                }
+
+                LOG_TRACE << "TCP transmitted payload #" << payload->stream_identifier() << ":" << payloads_transmitted << "...";
+                notify_payload_transmitted(handler, std::error_code());
+            });
+        });
+    });
+}
+
 void CdiTools::TcpConnection::add_stream(std::shared_ptr<Stream> stream)
 {
     if (streams_.size() > 0) {
@@ -221,3 +455,84 @@ void CdiTools::TcpConnection::add_stream(std::shared_ptr<Stream> stream)
 
     Connection::add_stream(stream);
 }
+
+std::string CdiTools::TcpConnection::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << format_settings(socket_settings_) << std::fixed << std::setprecision(1);
+
+    if (payloads_received_ > 0) {
+        statistics << ", reads/payload: " << static_cast<double>(read_operations_) / payloads_received_;
+    }
+
+    if (payloads_transmitted_ > 0) {
+        statistics << ", writes/payload: " << static_cast<double>(write_operations_) / payloads_transmitted_;
+    }
+
+    if (padded_payloads_ > 0 || dropped_payloads_ > 0) {
+        statistics << ", aborted payloads padded: " << padded_payloads_ << ", dropped: " << dropped_payloads_;
+    }
+
+    return statistics.str();
+}
+
+CdiTools::TcpConnection::SocketSettings CdiTools::TcpConnection::tune_socket(
+    tcp::socket& socket, std::shared_ptr<Stream> stream, Logger& logger)
+{
+    SocketSettings settings;
+    asio_error ec;
+
+    if (Configuration::tcp_autotune) {
+        int buffer_size = get_socket_buffer_size(stream);
+        socket.set_option(socket_base::send_buffer_size(buffer_size), ec);
+        socket.set_option(socket_base::receive_buffer_size(buffer_size), ec);
+        socket.set_option(tcp::no_delay(true), ec);
+
+#ifdef TCP_NOTSENT_LOWAT
+        // keep no more than a single payload queued in the kernel waiting to be sent
+        int low_watermark = stream->payload_size();
+        if (setsockopt(socket.native_handle(), IPPROTO_TCP, TCP_NOTSENT_LOWAT, &low_watermark, sizeof(low_watermark)) != 0) {
+            logger.debug() << "Failed to set the TCP_NOTSENT_LOWAT socket option, error: " << errno << ".";
+        }
+#endif
+    }
+
+    // report the effective values, which the kernel may have adjusted or capped (e.g. net.core.wmem_max)
+    socket_base::send_buffer_size send_buffer_size;
+    socket.get_option(send_buffer_size, ec);
+    settings.send_buffer_size = send_buffer_size.value();
+    socket_base::receive_buffer_size receive_buffer_size;
+    socket.get_option(receive_buffer_size, ec);
+    settings.receive_buffer_size = receive_buffer_size.value();
+    tcp::no_delay no_delay;
+    socket.get_option(no_delay, ec);
+    settings.no_delay = no_delay.value();
+
+#ifdef TCP_NOTSENT_LOWAT
+    socklen_t option_length = sizeof(settings.not_sent_low_watermark);
+    getsockopt(socket.native_handle(), IPPROTO_TCP, TCP_NOTSENT_LOWAT, &settings.not_sent_low_watermark, &option_length);
+#endif
+
+    if (Configuration::tcp_autotune && std::min(settings.send_buffer_size, settings.receive_buffer_size) < stream->payload_size()) {
+        logger.warning() << "Socket buffers are smaller than a payload (" << stream->payload_size() << " bytes)"
+            << " - " << format_settings(settings) << ". Consider raising the operating system limits.";
+    }
+
+    logger.debug() << "Socket settings - " << format_settings(settings) << ".";
+
+    return settings;
+}
+
+std::string CdiTools::TcpConnection::format_settings(const SocketSettings& settings)
+{
+    std::ostringstream text;
+    text << "sndbuf: " << settings.send_buffer_size
+        << ", rcvbuf: " << settings.receive_buffer_size
+        << ", nodelay: " << std::boolalpha << settings.no_delay;
+
+    if (settings.not_sent_low_watermark > 0) {
+        text << ", notsent_lowat: " << settings.not_sent_low_watermark;
+    }
+
+    return text.str();
+}
@@ -21,8 +21,30 @@ namespace CdiTools
         void async_transmit(Payload payload, TransmitHandler handler) override;
         inline ConnectionType get_type() const override { return ConnectionType::Tcp; }
         void add_stream(std::shared_ptr<Stream> stream) override;
+        std::string get_statistics() const override;
+
+        // kernel socket settings chosen for a connection
+        struct SocketSettings
+        {
+            int send_buffer_size{ 0 };
+            int receive_buffer_size{ 0 };
+            bool no_delay{ false };
+            int not_sent_low_watermark{ 0 };
+        };
+
+        static SocketSettings tune_socket(boost::asio::ip::tcp::socket& socket, std::shared_ptr<Stream> stream, Logger& logger);
+        static std::string format_settings(const SocketSettings& settings);
 
     private:
+        void receive_range(Payload payload, size_t offset, ReceiveHandler handler);
+        void transmit_range(Payload payload, size_t offset, TransmitHandler handler);
+
         boost::asio::ip::tcp::socket socket_;
+        SocketSettings socket_settings_;
+        std::atomic_int read_operations_;
+        std::atomic_int write_operations_;
+        std::shared_ptr<PayloadProgress> receiving_progress_;
+        std::atomic_int padded_payloads_;
+        std::atomic_int dropped_payloads_;
     };
 }
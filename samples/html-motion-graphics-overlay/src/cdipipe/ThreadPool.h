@@ -1,5 +1,13 @@
 #pragma once
 
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
 #include <boost/asio/thread_pool.hpp>
 #include <boost/asio/post.hpp>
 
@@ -20,6 +28,29 @@ namespace CdiTools
             boost::asio::post(pool_, token);
         }
 
+        inline boost::asio::thread_pool::executor_type get_executor() { return pool_.get_executor(); }
+
+        // runs task(0) to task(count - 1) on the calling thread and on idle pool threads, and returns when all
+        // are done; the calling thread takes part too, so the work completes even when every pool thread is busy
+        void parallel_for(int count, std::function<void(int)> task)
+        {
+            if (count <= 0) return;
+
+            auto parallel_task = std::make_shared<ParallelTask>();
+            parallel_task->task = std::move(task);
+            parallel_task->count = count;
+
+            int helpers = std::min<int>(count - 1, std::max(1u, std::thread::hardware_concurrency()) - 1);
+            for (int i = 0; i < helpers; i++) {
+                post([parallel_task]() { parallel_task->run(); });
+            }
+
+            parallel_task->run();
+
+            std::unique_lock<std::mutex> lock(parallel_task->gate);
+            parallel_task->done.wait(lock, [&]() { return parallel_task->completed == parallel_task->count; });
+        }
+
         static ThreadPool& instance() {
             static ThreadPool theInstance(std::thread::hardware_concurrency());
 
@@ -27,6 +58,28 @@ namespace CdiTools
         }
 
     private:
+        // work shared by the caller of parallel_for and the worker pool threads that join it
+        struct ParallelTask
+        {
+            std::function<void(int)> task;
+            int count;
+            std::atomic_int next_index{ 0 };
+            std::atomic_int completed{ 0 };
+            std::mutex gate;
+            std::condition_variable done;
+
+            void run()
+            {
+                for (int index = next_index++; index < count; index = next_index++) {
+                    task(index);
+                    if (++completed == count) {
+                        std::lock_guard<std::mutex> lock(gate);
+                        done.notify_all();
+                    }
+                }
+            }
+        };
+
         boost::asio::thread_pool pool_;
     };
 }
@@ -0,0 +1,121 @@
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#endif
+
+#include "ThreadScheduling.h"
+#include "Enum.h"
+
+namespace
+{
+#ifndef _WIN32
+    int get_native_policy(CdiTools::SchedulingPolicy policy)
+    {
+        return CdiTools::SchedulingPolicy::RoundRobin == policy ? SCHED_RR : SCHED_FIFO;
+    }
+
+    const char* get_native_policy_name(int native_policy)
+    {
+        switch (native_policy) {
+        case SCHED_FIFO: return "SCHED_FIFO";
+        case SCHED_RR: return "SCHED_RR";
+        default: return "SCHED_OTHER";
+        }
+    }
+
+    std::string describe_current_thread()
+    {
+        int native_policy = SCHED_OTHER;
+        sched_param parameters{};
+        pthread_getschedparam(pthread_self(), &native_policy, &parameters);
+
+        std::string description = get_native_policy_name(native_policy);
+        if (SCHED_OTHER != native_policy) {
+            description += ", priority " + std::to_string(parameters.sched_priority);
+        }
+
+#ifdef __linux__
+        int timer_slack_ns = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+        if (timer_slack_ns >= 0) {
+            description += ", timer slack " + std::to_string(timer_slack_ns) + " ns";
+        }
+#endif
+
+        return description;
+    }
+#endif
+}
+
+bool CdiTools::ThreadScheduling::configure_current_thread(SchedulingPolicy policy, int priority, int timer_slack_ns, std::string& description)
+{
+    bool success = true;
+    std::string failure;
+
+#ifdef _WIN32
+    // Windows has no real-time policies for individual threads, time critical priority is the closest match
+    if (SchedulingPolicy::Default != policy && !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+        success = false;
+        failure = "error " + std::to_string(GetLastError());
+    }
+
+    description = GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_TIME_CRITICAL
+        ? "time critical priority" : "normal priority";
+#else
+#ifdef __linux__
+    if (timer_slack_ns > 0 && prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(timer_slack_ns), 0, 0, 0) != 0) {
+        success = false;
+        failure = std::string("timer slack: ") + std::strerror(errno);
+    }
+#endif
+
+    if (SchedulingPolicy::Default != policy) {
+        int native_policy = get_native_policy(policy);
+        sched_param parameters{};
+        parameters.sched_priority = std::max(sched_get_priority_min(native_policy),
+            std::min(priority, sched_get_priority_max(native_policy)));
+
+        // unprivileged processes (no CAP_SYS_NICE or RLIMIT_RTPRIO) fail here and keep the default policy
+        int result = pthread_setschedparam(pthread_self(), native_policy, &parameters);
+        if (result != 0) {
+            success = false;
+            failure = (failure.empty() ? "" : failure + ", ") + get_native_policy_name(native_policy) + ": " + std::strerror(result);
+        }
+    }
+
+    description = describe_current_thread();
+#endif
+
+    if (!failure.empty()) {
+        description += " (requested " + enum_name(scheduling_policy_map, policy) + " failed - " + failure + ")";
+    }
+
+    return success;
+}
+
+bool CdiTools::ThreadScheduling::lock_memory(std::string& description)
+{
+#ifdef _WIN32
+    description = "not supported";
+
+    return false;
+#else
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        description = std::string("failed - ") + std::strerror(errno);
+
+        return false;
+    }
+
+    description = "locked";
+
+    return true;
+#endif
+}
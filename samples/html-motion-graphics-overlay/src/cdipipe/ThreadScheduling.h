@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+#include "SchedulingPolicy.h"
+
+namespace CdiTools
+{
+    namespace ThreadScheduling
+    {
+        // Applies the scheduling policy, priority and timer slack to the calling thread. Returns false
+        // when the policy could not be applied, typically because the process lacks the privileges,
+        // in which case the thread keeps the default policy. The effective settings are returned in
+        // 'description'.
+        bool configure_current_thread(SchedulingPolicy policy, int priority, int timer_slack_ns, std::string& description);
+
+        // Locks the current and future pages of the process in memory to avoid page faults on the
+        // payload path. Returns false when locking is not permitted or not supported.
+        bool lock_memory(std::string& description);
+    }
+}
@@ -0,0 +1,173 @@
+#include <ctime>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "TimeSource.h"
+#include "Configuration.h"
+#include "Enum.h"
+
+static const char* logger_name = "TimeSource";
+
+namespace
+{
+    // the reference offset is refreshed at this interval to follow adjustments of the reference clock
+    const int64_t calibration_interval_ns = 1000000000;
+    const int calibration_samples = 5;
+    const int system_clock_id = -1;
+
+#ifdef __linux__
+    // dynamic POSIX clock identifier of an open PTP hardware clock device
+    inline clockid_t get_device_clock_id(int device_handle)
+    {
+        return static_cast<clockid_t>((~static_cast<unsigned int>(device_handle) << 3) | 3);
+    }
+#endif
+}
+
+CdiTools::TimeSource::TimeSource(TimeSourceType type, const std::string& ptp_device)
+    : type_{ TimeSourceType::Utc }
+    , name_{ "system realtime clock" }
+    , clock_id_{ system_clock_id }
+    , device_handle_{ -1 }
+    , offset_ns_{ 0 }
+    , next_calibration_ns_{ 0 }
+    , logger_{ logger_name }
+{
+    if (!open(type, ptp_device)) {
+        LOG_WARNING << "Time source '" << enum_name(time_source_type_map, type) << "' is not available, using the " << name_ << " instead.";
+    }
+
+    calibrate();
+    LOG_INFO << "Using the " << name_ << " as the reference time source.";
+}
+
+CdiTools::TimeSource::~TimeSource()
+{
+#ifndef _WIN32
+    if (device_handle_ >= 0) {
+        close(device_handle_);
+    }
+#endif
+}
+
+CdiTools::TimeSource& CdiTools::TimeSource::instance()
+{
+    static TimeSource instance{ Configuration::time_source, Configuration::ptp_device };
+
+    return instance;
+}
+
+std::chrono::nanoseconds CdiTools::TimeSource::now()
+{
+    return to_reference_time(clock::now());
+}
+
+std::chrono::nanoseconds CdiTools::TimeSource::to_reference_time(clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()) + get_offset();
+}
+
+CdiTools::TimeSource::clock::time_point CdiTools::TimeSource::to_steady_time(std::chrono::nanoseconds reference_time)
+{
+    return clock::time_point(std::chrono::duration_cast<clock::duration>(reference_time - get_offset()));
+}
+
+bool CdiTools::TimeSource::open(TimeSourceType type, const std::string& ptp_device)
+{
+    switch (type) {
+    case TimeSourceType::Utc:
+        return true;
+    case TimeSourceType::Tai:
+#ifdef CLOCK_TAI
+        {
+            timespec time;
+            if (clock_gettime(CLOCK_TAI, &time) == 0) {
+                type_ = type;
+                name_ = "TAI clock";
+                clock_id_ = CLOCK_TAI;
+
+                return true;
+            }
+        }
+#endif
+        return false;
+    case TimeSourceType::Ptp:
+#ifdef __linux__
+        {
+            int device_handle = ::open(ptp_device.c_str(), O_RDONLY);
+            timespec time;
+            if (device_handle < 0 || clock_gettime(get_device_clock_id(device_handle), &time) != 0) {
+                LOG_ERROR << "Failed to open the PTP hardware clock '" << ptp_device << "': " << std::strerror(errno) << ".";
+                if (device_handle >= 0) {
+                    close(device_handle);
+                }
+
+                return false;
+            }
+
+            type_ = type;
+            name_ = "PTP hardware clock '" + ptp_device + "'";
+            device_handle_ = device_handle;
+            clock_id_ = get_device_clock_id(device_handle);
+
+            return true;
+        }
+#else
+        return false;
+#endif
+    }
+
+    return false;
+}
+
+int64_t CdiTools::TimeSource::read_reference() const
+{
+#ifndef _WIN32
+    if (clock_id_ != system_clock_id) {
+        timespec time;
+        clock_gettime(static_cast<clockid_t>(clock_id_), &time);
+
+        return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+    }
+#endif
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void CdiTools::TimeSource::calibrate()
+{
+    // a reference read bracketed by two steady clock reads, keeping the sample with the narrowest bracket
+    int64_t best_offset = 0;
+    int64_t best_bracket = INT64_MAX;
+    for (int i = 0; i < calibration_samples; i++) {
+        auto before = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+        auto reference = read_reference();
+        auto after = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+        if (after - before < best_bracket) {
+            best_bracket = after - before;
+            best_offset = reference - (before + (after - before) / 2);
+        }
+    }
+
+    offset_ns_ = best_offset;
+    next_calibration_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count()
+        + calibration_interval_ns;
+}
+
+std::chrono::nanoseconds CdiTools::TimeSource::get_offset()
+{
+    // the first reader past the calibration deadline refreshes the offset, others keep using the cached value
+    auto next_calibration_ns = next_calibration_ns_.load(std::memory_order_relaxed);
+    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+    if (now_ns >= next_calibration_ns
+        && next_calibration_ns_.compare_exchange_strong(next_calibration_ns, INT64_MAX, std::memory_order_acquire)) {
+        calibrate();
+    }
+
+    return std::chrono::nanoseconds(offset_ns_.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "TimeSourceType.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Process-wide reference clock used for origination timestamps, frame clock alignment and latency
+    // measurements. The reference is one of the system realtime clock, the TAI clock or a PTP hardware
+    // clock (/dev/ptpN). Reading the reference can be expensive, so its offset from the steady clock is
+    // cached and refreshed periodically, and each read costs no more than a steady clock read.
+    class TimeSource
+    {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        ~TimeSource();
+
+        static TimeSource& instance();
+
+        // time elapsed since the epoch of the reference clock
+        std::chrono::nanoseconds now();
+        std::chrono::nanoseconds to_reference_time(clock::time_point time);
+        clock::time_point to_steady_time(std::chrono::nanoseconds reference_time);
+        inline TimeSourceType get_type() const { return type_; }
+        const std::string& get_name() const { return name_; }
+
+    private:
+        TimeSource(TimeSourceType type, const std::string& ptp_device);
+
+        bool open(TimeSourceType type, const std::string& ptp_device);
+        int64_t read_reference() const;
+        void calibrate();
+        std::chrono::nanoseconds get_offset();
+
+        TimeSourceType type_;
+        std::string name_;
+        int clock_id_;
+        int device_handle_;
+        std::atomic<int64_t> offset_ns_;
+        std::atomic<int64_t> next_calibration_ns_;
+        Logger logger_;
+    };
+}
@@ -0,0 +1,7 @@
+#include "TimeSourceType.h"
+
+enum_map<CdiTools::TimeSourceType> CdiTools::time_source_type_map{
+    { "Utc", TimeSourceType::Utc },
+    { "Tai", TimeSourceType::Tai },
+    { "Ptp", TimeSourceType::Ptp }
+};
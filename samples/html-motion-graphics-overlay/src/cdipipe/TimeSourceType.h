@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Enum.h"
+
+namespace CdiTools
+{
+    enum class TimeSourceType
+    {
+        Utc,
+        Tai,
+        Ptp
+    };
+
+    extern enum_map<TimeSourceType> time_source_type_map;
+}
@@ -0,0 +1,80 @@
+#include <vector>
+#include <algorithm>
+#include <sstream>
+
+#include "VideoConcealment.h"
+#include "VideoStream.h"
+#include "PayloadRange.h"
+
+CdiTools::VideoConcealmentStage::VideoConcealmentStage()
+    : name_{ "video_concealment" }
+    , frames_repeated_{ 0 }
+    , frames_patched_{ 0 }
+    , frames_dropped_{ 0 }
+    , logger_{ "VideoConcealment" }
+{
+}
+
+CdiTools::Payload CdiTools::VideoConcealmentStage::process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec)
+{
+    auto video_stream = std::dynamic_pointer_cast<VideoStream>(stream);
+    if (video_stream == nullptr) return payload;
+
+    std::lock_guard<std::mutex> lock(gate_);
+    if (!payload->is_damaged()) {
+        last_frame_ = payload;
+        return payload;
+    }
+
+    int frame_size = video_stream->payload_size();
+    if (last_frame_ == nullptr || last_frame_->get_size() < frame_size) {
+        // nothing to conceal with yet
+        frames_dropped_++;
+        return nullptr;
+    }
+
+    int64_t frame_duration_us = 1000000ll * video_stream->frame_rate_denominator() / video_stream->frame_rate_numerator();
+    stream->concealment(frame_duration_us);
+
+    // CDI does not report which parts of a damaged payload are missing, only the bytes received are kept
+    size_t received_size = static_cast<size_t>(std::max(0, std::min(payload->get_size(), frame_size)));
+    std::vector<CdiSglEntry> entries;
+    auto add_range = [&](const Payload& source, size_t offset, size_t size) {
+        PayloadRange::for_each(*source, offset, size, [&](uint8_t* data, size_t, size_t length) {
+            CdiSglEntry entry = { 0 };
+            entry.address_ptr = data;
+            entry.size_in_bytes = static_cast<int>(length);
+            entries.push_back(entry);
+        });
+    };
+
+    add_range(payload, 0, received_size);
+    add_range(last_frame_, received_size, frame_size - received_size);
+
+    // a repeated frame is a new payload as well, the previous one may still be queued or being sent
+    if (received_size == 0) {
+        frames_repeated_++;
+        LOG_DEBUG << "Repeated the previous frame of video stream #" << stream->id() << " in place of a lost frame.";
+    }
+    else {
+        frames_patched_++;
+        LOG_DEBUG << "Patched " << frame_size - received_size << " bytes of a damaged frame of video stream #" << stream->id()
+            << " from the previous frame.";
+    }
+
+    auto patched_frame = PayloadData::compose(payload->stream_identifier(), entries, { payload, last_frame_ });
+    patched_frame->metadata().copy_from(payload->metadata());
+    patched_frame->set_damaged(false);
+
+    return patched_frame;
+}
+
+std::string CdiTools::VideoConcealmentStage::get_statistics() const
+{
+    std::ostringstream statistics;
+    statistics << "frames repeated: " << frames_repeated_
+        << ", patched: " << frames_patched_
+        << ", dropped: " << frames_dropped_;
+
+    return statistics.str();
+}
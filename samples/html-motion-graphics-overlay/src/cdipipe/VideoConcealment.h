@@ -0,0 +1,36 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+
+#include "IStage.h"
+#include "Logger.h"
+
+namespace CdiTools
+{
+    // Keeps the cadence of a video stream when frames are received with errors. A damaged frame that holds
+    // part of a picture keeps the bytes received and takes the rest from the previous good frame; one with
+    // no data repeats the previous frame. Both are new payloads that carry the metadata of the damaged frame,
+    // built from SG list entries that point into the frames involved, so no pixels are copied.
+    class VideoConcealmentStage
+        : public IStage
+    {
+    public:
+        VideoConcealmentStage();
+
+        inline const std::string& get_name() const override final { return name_; }
+        inline PayloadType get_input_type() const override final { return PayloadType::Video; }
+        inline PayloadType get_output_type() const override final { return PayloadType::Video; }
+        Payload process(Payload payload, std::shared_ptr<Stream> stream, uint32_t sequence, std::error_code& ec) override final;
+        std::string get_statistics() const override final;
+
+    private:
+        std::string name_;
+        std::mutex gate_;
+        Payload last_frame_;
+        std::atomic<int64_t> frames_repeated_;
+        std::atomic<int64_t> frames_patched_;
+        std::atomic<int64_t> frames_dropped_;
+        Logger logger_;
+    };
+}
@@ -20,7 +20,7 @@ SET "FFPLAY_GLOBAL_OPTIONS= -hide_banner -loglevel info"
 
 SET RECEIVER_MODE_OPTIONS="play stream store"
 SET ROLE_OPTIONS="source transmitter receiver both"
-SET CHANNEL_OPTIONS="cdistream cdi tcp"
+SET CHANNEL_OPTIONS="cdistream cdi cdiauto tcp"
 SET ADAPTER_OPTIONS="efa socketlibfabric"
 SET FORMAT_OPTIONS="rgb mp4"
 SET LOG_LEVEL_OPTIONS="trace debug info warning error"
@@ -644,7 +644,7 @@ ECHO Options:
 ECHO     -role ^<type^>                          : type of role: transmitter ^| receiver ^| both (optional, default: !ROLE!)
 ECHO     -mode ^<option^>                        : receiver mode: play ^| stream ^| store (optional, default: !RECEIVER_MODE!)
 ECHO     -log_level ^<value^>                    : log level : trace ^| debug ^| info ^| warning ^| error (optional, default: !LOG_LEVEL!)
-ECHO     -channel ^<type^>                       : type of channel: cdi ^| cdistream ^| tcp (optional, default: !DEFAULT_CHANNEL_TYPE!)
+ECHO     -channel ^<type^>                       : type of channel: cdi ^| cdistream ^| cdiauto ^| tcp (optional, default: !DEFAULT_CHANNEL_TYPE!)
 ECHO     -width ^<value^>                        : input source frame width (required in receiver mode, default: !DEFAULT_VIDEO_WIDTH!)
 ECHO     -height ^<value^>                       : input source frame height (required in receiver mode, default: !DEFAULT_VIDEO_HEIGHT!)
 ECHO     -framerate ^<value^>                    : input source frame rate (required in receiver mode, default: !DEFAULT_VIDEO_AVG_FRAME_RATE!)